@@ -0,0 +1,297 @@
+//=====================================================
+// AllocationTracker.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+const char* AllocationTracker::UNTAGGED = "(untagged)";
+
+unsigned int AllocationTracker::s_frameBudget = 0;
+std::vector<AllocationTracker::TagTotals> AllocationTracker::s_lastFrameTotals;
+unsigned int AllocationTracker::s_lastFrameAllocations = 0;
+unsigned long long AllocationTracker::s_lastFrameBytes = 0;
+unsigned int AllocationTracker::s_numFrames = 0;
+unsigned int AllocationTracker::s_numFramesOverBudget = 0;
+unsigned int AllocationTracker::s_worstFrameAllocations = 0;
+
+namespace{
+	///=====================================================
+	/// The console isn't linked into the headless build
+	///=====================================================
+	void PrintAllocationMessage(const char* message){
+#ifndef ASTEROIDS_HEADLESS
+		ConsolePrintf("%s", message);
+#else
+		printf("%s", message);
+#endif
+	}
+}
+
+#ifdef ASTEROIDS_TRACK_ALLOCATIONS
+namespace{
+	//everything the allocator touches is plain static or thread_local data, so tracking itself never allocates
+	const int TRACKED_THREADS = 32;
+	const int TAGS_PER_THREAD = 64;
+	const int TAG_DEPTH = 16;
+
+	struct TagCounter{
+		std::atomic<const char*> m_tag;
+		std::atomic<unsigned int> m_numAllocations;
+		std::atomic<unsigned long long> m_numBytes;
+	};
+
+	///=====================================================
+	/// Normally written by one thread only; threads past TRACKED_THREADS share the last table, which the atomics keep safe
+	///=====================================================
+	struct ThreadCounters{
+		TagCounter m_tags[TAGS_PER_THREAD];
+	};
+
+	ThreadCounters s_threadCounters[TRACKED_THREADS];
+	std::atomic<int> s_numThreadCounters(0);
+
+	thread_local int s_threadCountersIndex = -1;
+	thread_local const char* s_tagStack[TAG_DEPTH];
+	thread_local int s_tagDepth = 0;
+	thread_local bool s_isTrackingSuspended = false;
+
+	///=====================================================
+	///
+	///=====================================================
+	ThreadCounters& GetCurrentThreadCounters(){
+		if (s_threadCountersIndex < 0){
+			int index = s_numThreadCounters.fetch_add(1);
+			s_threadCountersIndex = (index < TRACKED_THREADS) ? index : TRACKED_THREADS - 1;
+		}
+		return s_threadCounters[s_threadCountersIndex];
+	}
+
+	///=====================================================
+	/// Tags past TAGS_PER_THREAD are counted as untagged
+	///=====================================================
+	TagCounter& FindOrAddTagCounter(ThreadCounters& counters, const char* tag){
+		for (int tagIndex = 0; tagIndex < TAGS_PER_THREAD; ++tagIndex){
+			TagCounter& counter = counters.m_tags[tagIndex];
+			const char* counterTag = counter.m_tag.load(std::memory_order_acquire);
+			if (counterTag == tag)
+				return counter;
+
+			if (counterTag == nullptr){
+				const char* expectedTag = nullptr;
+				if (counter.m_tag.compare_exchange_strong(expectedTag, tag, std::memory_order_acq_rel) || expectedTag == tag)
+					return counter;
+			}
+		}
+
+		return (tag == AllocationTracker::UNTAGGED) ? counters.m_tags[TAGS_PER_THREAD - 1] : FindOrAddTagCounter(counters, AllocationTracker::UNTAGGED);
+	}
+
+	///=====================================================
+	///
+	///=====================================================
+	void* TrackedAllocate(std::size_t numBytes){
+		if (!s_isTrackingSuspended)
+			AllocationTracker::RecordAllocation(numBytes);
+		return malloc((numBytes > 0) ? numBytes : 1);
+	}
+
+	///=====================================================
+	///
+	///=====================================================
+	bool IsMoreAllocations(const AllocationTracker::TagTotals& first, const AllocationTracker::TagTotals& second){
+		return first.m_numAllocations > second.m_numAllocations;
+	}
+}
+
+///=====================================================
+///
+///=====================================================
+void* operator new(std::size_t numBytes){
+	void* memory = TrackedAllocate(numBytes);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](std::size_t numBytes){
+	void* memory = TrackedAllocate(numBytes);
+	if (memory == nullptr)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new(std::size_t numBytes, const std::nothrow_t&) noexcept{
+	return TrackedAllocate(numBytes);
+}
+
+void* operator new[](std::size_t numBytes, const std::nothrow_t&) noexcept{
+	return TrackedAllocate(numBytes);
+}
+
+void operator delete(void* memory) noexcept{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept{
+	free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept{
+	free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept{
+	free(memory);
+}
+
+///=====================================================
+///
+///=====================================================
+bool AllocationTracker::IsCompiledIn(){
+	return true;
+}
+
+///=====================================================
+/// Scopes deeper than TAG_DEPTH keep counting against the deepest one that fit
+///=====================================================
+void AllocationTracker::PushTag(const char* tag){
+	if (s_tagDepth < TAG_DEPTH)
+		s_tagStack[s_tagDepth] = tag;
+	++s_tagDepth;
+}
+
+///=====================================================
+///
+///=====================================================
+void AllocationTracker::PopTag(){
+	FATAL_ASSERT(s_tagDepth > 0);
+	--s_tagDepth;
+}
+
+///=====================================================
+///
+///=====================================================
+void AllocationTracker::RecordAllocation(size_t numBytes){
+	const char* tag = UNTAGGED;
+	if (s_tagDepth > 0)
+		tag = s_tagStack[((s_tagDepth < TAG_DEPTH) ? s_tagDepth : TAG_DEPTH) - 1];
+
+	TagCounter& counter = FindOrAddTagCounter(GetCurrentThreadCounters(), tag);
+	counter.m_numAllocations.fetch_add(1, std::memory_order_relaxed);
+	counter.m_numBytes.fetch_add(numBytes, std::memory_order_relaxed);
+}
+
+///=====================================================
+/// Call once per frame on the main thread; collects and resets every thread's counters
+/// Anything this allocates, including the budget report, is left out of the counts
+///=====================================================
+void AllocationTracker::FinishFrame(){
+	s_isTrackingSuspended = true;
+
+	s_lastFrameTotals.clear();
+	s_lastFrameAllocations = 0;
+	s_lastFrameBytes = 0;
+
+	int numThreadCounters = std::min(s_numThreadCounters.load(), TRACKED_THREADS);
+	for (int threadIndex = 0; threadIndex < numThreadCounters; ++threadIndex){
+		for (int tagIndex = 0; tagIndex < TAGS_PER_THREAD; ++tagIndex){
+			TagCounter& counter = s_threadCounters[threadIndex].m_tags[tagIndex];
+			const char* tag = counter.m_tag.load(std::memory_order_acquire);
+			if (tag == nullptr) break;
+
+			unsigned int numAllocations = counter.m_numAllocations.exchange(0, std::memory_order_relaxed);
+			unsigned long long numBytes = counter.m_numBytes.exchange(0, std::memory_order_relaxed);
+			if (numAllocations == 0) continue;
+
+			s_lastFrameAllocations += numAllocations;
+			s_lastFrameBytes += numBytes;
+
+			std::vector<TagTotals>::iterator totalsIter = s_lastFrameTotals.begin();
+			while (totalsIter != s_lastFrameTotals.end() && totalsIter->m_tag != tag){
+				++totalsIter;
+			}
+			if (totalsIter == s_lastFrameTotals.end()){
+				TagTotals totals;
+				totals.m_tag = tag;
+				totals.m_numAllocations = 0;
+				totals.m_numBytes = 0;
+				s_lastFrameTotals.push_back(totals);
+				totalsIter = s_lastFrameTotals.end() - 1;
+			}
+			totalsIter->m_numAllocations += numAllocations;
+			totalsIter->m_numBytes += numBytes;
+		}
+	}
+	std::sort(s_lastFrameTotals.begin(), s_lastFrameTotals.end(), IsMoreAllocations);
+
+	++s_numFrames;
+	if (s_lastFrameAllocations > s_worstFrameAllocations)
+		s_worstFrameAllocations = s_lastFrameAllocations;
+
+	if (s_frameBudget > 0 && s_lastFrameAllocations > s_frameBudget){
+		++s_numFramesOverBudget;
+
+		char message[256];
+		snprintf(message, sizeof(message), "Frame %u over allocation budget: %u allocations (%llu bytes), budget %u, worst scope %s\n",
+			s_numFrames, s_lastFrameAllocations, s_lastFrameBytes, s_frameBudget, s_lastFrameTotals.front().m_tag);
+		PrintAllocationMessage(message);
+	}
+
+	s_isTrackingSuspended = false;
+}
+#else
+///=====================================================
+///
+///=====================================================
+bool AllocationTracker::IsCompiledIn(){
+	return false;
+}
+
+void AllocationTracker::PushTag(const char* /*tag*/){
+}
+
+void AllocationTracker::PopTag(){
+}
+
+void AllocationTracker::RecordAllocation(size_t /*numBytes*/){
+}
+
+void AllocationTracker::FinishFrame(){
+}
+#endif
+
+///=====================================================
+/// Forgets the worst frame and the frame counts, e.g. once loading is done
+///=====================================================
+void AllocationTracker::ResetFrameStatistics(){
+	s_numFrames = 0;
+	s_numFramesOverBudget = 0;
+	s_worstFrameAllocations = 0;
+}
+
+///=====================================================
+/// One line per scope, most allocations first
+///=====================================================
+void AllocationTracker::PrintLastFrame(){
+	char message[256];
+	if (!IsCompiledIn()){
+		PrintAllocationMessage("Allocation tracking is not compiled in; build with ASTEROIDS_TRACK_ALLOCATIONS\n");
+		return;
+	}
+
+	snprintf(message, sizeof(message), "Frame %u: %u allocations, %llu bytes (worst frame %u, %u of %u frames over budget %u)\n",
+		s_numFrames, s_lastFrameAllocations, s_lastFrameBytes, s_worstFrameAllocations, s_numFramesOverBudget, s_numFrames, s_frameBudget);
+	PrintAllocationMessage(message);
+
+	for (std::vector<TagTotals>::const_iterator totalsIter = s_lastFrameTotals.begin(); totalsIter != s_lastFrameTotals.end(); ++totalsIter){
+		snprintf(message, sizeof(message), "  %8u allocations %12llu bytes  %s\n", totalsIter->m_numAllocations, totalsIter->m_numBytes, totalsIter->m_tag);
+		PrintAllocationMessage(message);
+	}
+}
\ No newline at end of file
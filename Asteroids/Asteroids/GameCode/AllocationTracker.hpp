@@ -0,0 +1,79 @@
+//=====================================================
+// AllocationTracker.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_AllocationTracker__
+#define __included_AllocationTracker__
+
+#include <cstddef>
+#include <vector>
+
+///=====================================================
+/// Counts heap allocations and bytes per frame, grouped by the innermost ALLOCATION_SCOPE on the allocating thread
+/// Defining ASTEROIDS_TRACK_ALLOCATIONS replaces the global operator new/delete, so only define it in builds where nothing else replaces them
+/// That is the headless Makefile's default; the Windows game links the engine's memory manager, so it leaves it off and has no MEMORY_ console commands
+/// Without it every call here is a no-op and ALLOCATION_SCOPE compiles away
+///=====================================================
+class AllocationTracker{
+public:
+	struct TagTotals{
+		const char* m_tag;
+		unsigned int m_numAllocations;
+		unsigned long long m_numBytes;
+	};
+
+	static const char* UNTAGGED;
+
+	static bool IsCompiledIn();
+
+	static void PushTag(const char* tag);
+	static void PopTag();
+	static void RecordAllocation(size_t numBytes);
+
+	static void FinishFrame();
+	static void ResetFrameStatistics();
+	static void PrintLastFrame();
+
+	//0 turns the budget off; otherwise every frame with more allocations than this is reported as it finishes
+	static inline void SetFrameBudget(unsigned int maxAllocationsPerFrame){ s_frameBudget = maxAllocationsPerFrame; }
+	static inline unsigned int GetFrameBudget(){ return s_frameBudget; }
+
+	static inline const std::vector<TagTotals>& GetLastFrameTotals(){ return s_lastFrameTotals; }
+	static inline unsigned int GetLastFrameAllocations(){ return s_lastFrameAllocations; }
+	static inline unsigned long long GetLastFrameBytes(){ return s_lastFrameBytes; }
+	static inline unsigned int GetNumFrames(){ return s_numFrames; }
+	static inline unsigned int GetNumFramesOverBudget(){ return s_numFramesOverBudget; }
+	static inline unsigned int GetWorstFrameAllocations(){ return s_worstFrameAllocations; }
+
+private:
+	static unsigned int s_frameBudget;
+	static std::vector<TagTotals> s_lastFrameTotals;
+	static unsigned int s_lastFrameAllocations;
+	static unsigned long long s_lastFrameBytes;
+	static unsigned int s_numFrames;
+	static unsigned int s_numFramesOverBudget;
+	static unsigned int s_worstFrameAllocations;
+};
+
+///=====================================================
+///
+///=====================================================
+class AllocationScope{
+public:
+	inline explicit AllocationScope(const char* tag){ AllocationTracker::PushTag(tag); }
+	inline ~AllocationScope(){ AllocationTracker::PopTag(); }
+};
+
+#ifdef ASTEROIDS_TRACK_ALLOCATIONS
+#define ALLOCATION_CONCATENATE_INNER(a, b) a##b
+#define ALLOCATION_CONCATENATE(a, b) ALLOCATION_CONCATENATE_INNER(a, b)
+//tag must be a string literal; scopes are compared by address
+#define ALLOCATION_SCOPE(tag) AllocationScope ALLOCATION_CONCATENATE(allocationScope, __LINE__)(tag)
+#else
+#define ALLOCATION_SCOPE(tag)
+#endif
+
+#endif
\ No newline at end of file
@@ -4,107 +4,149 @@
 //=====================================================
 
 #include "Asteroid.hpp"
-#include "Engine/Math/MathUtils.hpp"
+#include "RandomGenerator.hpp"
+#include "Engine/Core/Assert.hpp"
+#ifndef ASTEROIDS_HEADLESS
 #include "Engine/Renderer/Material.hpp"
+#endif
 
 const float Asteroid::BASE_ASTEROID_RADIUS = 6.5f;
 
-std::vector<Vertex_Anim> Asteroid::ASTEROID_VERTICES_CROSS;
-std::vector<Vertex_Anim> Asteroid::ASTEROID_VERTICES_MUSHROOM;
-std::vector<Vertex_Anim> Asteroid::ASTEROID_VERTICES_TREE;
-std::vector<Vertex_Anim> Asteroid::ASTEROID_VERTICES_TEXAS;
-std::vector<Vertex_Anim> Asteroid::ASTEROID_VERTICES[4];
+#ifndef ASTEROIDS_HEADLESS
+
+static const Vec3 CROSS_OUTLINE[] = {
+	Vec3(-7.0f, -7.0f), Vec3(-7.0f, 0.0f), Vec3(0.0f, 7.0f), Vec3(7.0f, 0.0f), Vec3(7.0f, -7.0f), Vec3(0.0f, -14.0f)
+};
+static const Vec3 MUSHROOM_OUTLINE[] = {
+	Vec3(-7.0f, -7.0f), Vec3(7.0f, -7.0f), Vec3(0.0f, 7.0f)
+};
+static const Vec3 TREE_OUTLINE[] = {
+	Vec3(-7.0f, -7.0f), Vec3(-7.0f, 7.0f), Vec3(7.0f, 7.0f), Vec3(7.0f, -7.0f)
+};
+static const Vec3 TEXAS_OUTLINE[] = {
+	Vec3(-3.0f, -6.0f), Vec3(-6.0f, -3.0f), Vec3(-7.0f, 0.0f), Vec3(-6.0f, 3.0f), Vec3(-3.0f, 6.0f), Vec3(7.0f, 0.0f)
+};
 
 ///=====================================================
 /// 
 ///=====================================================
-Asteroid::Asteroid(const Vec2& position, AsteroidSize asteroidSize, const OpenGLRenderer& renderer, EngineAndrew::Material& material) :
-GameEntity(position, renderer, material),
-m_size(asteroidSize),
-m_shape((Asteroid::AsteroidShape)GetRandomIntLessThan(4)) {
-	if (ASTEROID_VERTICES_CROSS.empty())
-		CreateVerticesBasedOnShape();
-
-	m_mesh.m_vertices = ASTEROID_VERTICES[m_shape];
+void Asteroid::CreateVertices(AsteroidShape shape, std::vector<Vertex_Anim>& out_vertices){
+	const Vec3* outline = nullptr;
+	int numOutlineVertices = 0;
+
+	switch (shape){
+	case ASTEROID_SHAPE_CROSS:
+		outline = CROSS_OUTLINE;
+		numOutlineVertices = sizeof(CROSS_OUTLINE) / sizeof(Vec3);
+		break;
+	case ASTEROID_SHAPE_MUSHROOM:
+		outline = MUSHROOM_OUTLINE;
+		numOutlineVertices = sizeof(MUSHROOM_OUTLINE) / sizeof(Vec3);
+		break;
+	case ASTEROID_SHAPE_TREE:
+		outline = TREE_OUTLINE;
+		numOutlineVertices = sizeof(TREE_OUTLINE) / sizeof(Vec3);
+		break;
+	case ASTEROID_SHAPE_TEXAS:
+		outline = TEXAS_OUTLINE;
+		numOutlineVertices = sizeof(TEXAS_OUTLINE) / sizeof(Vec3);
+		break;
+	default:
+		FATAL_ERROR("Invalid asteroid shape");
+		return;
+	}
+
+	out_vertices.clear();
+	for (int i = 0; i < numOutlineVertices; ++i){
+		out_vertices.push_back(Vertex_Anim(outline[i]));
+	}
+}
 
-	m_physics.m_velocity = Vec2(GetRandomFloatInRange(20.0f, 40.0f), GetRandomFloatInRange(20.0f, 40.0f));
-	if (GetRandomIntLessThan(2)) m_physics.m_velocity.x = -m_physics.m_velocity.x;
-	if (GetRandomIntLessThan(2)) m_physics.m_velocity.y = -m_physics.m_velocity.y;
+///=====================================================
+/// Builds and uploads the immutable mesh for one shape; the World keeps one per shape, so spawning and splitting never touch the driver
+///=====================================================
+void Asteroid::CreateMesh(AsteroidShape shape, const OpenGLRenderer* renderer, EngineAndrew::Material& material, EngineAndrew::Mesh& out_mesh){
+	out_mesh.Startup(renderer);
+	material.BindVertexData(out_mesh);
 
-	m_physics.m_orientationDegrees = GetRandomFloatInRange(0.0f, 360.0f);
+	CreateVertices(shape, out_mesh.m_vertices);
+	out_mesh.UseDefaultIndeces();
+	out_mesh.SendVertexDataToBuffer(renderer);
+}
+#endif
 
-	m_physics.m_angularVelocity = GetRandomFloatInRange(20.0f, 40.0f);
-	if (GetRandomIntLessThan(2)) m_physics.m_angularVelocity = -m_physics.m_angularVelocity;
+///=====================================================
+/// 
+///=====================================================
+AsteroidStore::AsteroidStore() :
+EntityStore(),
+m_sizes(),
+m_shapes(){
+}
 
-	m_radius = BASE_ASTEROID_RADIUS * m_size;
+///=====================================================
+/// 
+///=====================================================
+void AsteroidStore::Reserve(int capacity){
+	EntityStore::Reserve(capacity);
+	m_sizes.reserve(capacity);
+	m_shapes.reserve(capacity);
+}
 
-	m_mesh.UseDefaultIndeces();
-	m_mesh.SendVertexDataToBuffer(&renderer);
+///=====================================================
+/// 
+///=====================================================
+void AsteroidStore::Clear(){
+	EntityStore::Clear();
+	m_sizes.clear();
+	m_shapes.clear();
 }
 
 ///=====================================================
 /// 
 ///=====================================================
-void Asteroid::Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld) const {
-	FATAL_ASSERT(objectToWorld != nullptr);
-	Matrix4 modelMatrix = Matrix4::CreateScale((float)m_size);
-	modelMatrix.RotateDegreesAboutZ(m_physics.m_orientationDegrees);
-	modelMatrix.Translate(m_physics.m_position);
-	objectToWorld->m_data[0] = modelMatrix;
+int AsteroidStore::Add(const Vec2& position, Asteroid::AsteroidSize asteroidSize, RandomGenerator& random){
+	int index = EntityStore::Add(position, Vec2(0.0f, 0.0f), 0.0f, 0.0f, 0.0f);
+	m_sizes.push_back(asteroidSize);
+	m_shapes.push_back(Asteroid::ASTEROID_SHAPE_CROSS);
+
+	Reset(index, position, asteroidSize, random);
+	return index;
+}
+
+///=====================================================
+/// Gives the asteroid at index a new random shape, heading and spin, as if it had just spawned
+/// Each random draw is its own statement so the call order can't change with the compiler's argument evaluation order
+///=====================================================
+void AsteroidStore::Reset(int index, const Vec2& position, Asteroid::AsteroidSize asteroidSize, RandomGenerator& random){
+	FATAL_ASSERT(index >= 0 && index < Size());
+	m_shapes[index] = (Asteroid::AsteroidShape)random.GetIntLessThan(Asteroid::NUM_ASTEROID_SHAPES);
+	m_sizes[index] = asteroidSize;
+	m_positions[index] = position;
+
+	Vec2& velocity = m_velocities[index];
+	velocity.x = random.GetFloatInRange(20.0f, 40.0f);
+	velocity.y = random.GetFloatInRange(20.0f, 40.0f);
+	if (random.GetIntLessThan(2)) velocity.x = -velocity.x;
+	if (random.GetIntLessThan(2)) velocity.y = -velocity.y;
 
-	material.Render(m_mesh);
+	m_orientationsDegrees[index] = random.GetFloatInRange(0.0f, 360.0f);
+
+	float& angularVelocity = m_angularVelocities[index];
+	angularVelocity = random.GetFloatInRange(20.0f, 40.0f);
+	if (random.GetIntLessThan(2)) angularVelocity = -angularVelocity;
+
+	m_radii[index] = Asteroid::BASE_ASTEROID_RADIUS * asteroidSize;
 }
 
 ///=====================================================
 /// 
 ///=====================================================
-void Asteroid::CreateVerticesBasedOnShape() const{
-	Vertex_Anim v0, v1, v2, v3, v4, v5, v6, v7;
-	v0.m_position = Vec3(-7.0f, -7.0f, 0.0f);
-	v1.m_position = Vec3(-7.0f, 0.0f);
-	v2.m_position = Vec3(0.0f, 7.0f);
-	v3.m_position = Vec3(7.0f, 0.0f);
-	v4.m_position = Vec3(7.0f, -7.0f);
-	v5.m_position = Vec3(0.0f, -14.0f);
-	ASTEROID_VERTICES_CROSS.push_back(v0);
-	ASTEROID_VERTICES_CROSS.push_back(v1);
-	ASTEROID_VERTICES_CROSS.push_back(v2);
-	ASTEROID_VERTICES_CROSS.push_back(v3);
-	ASTEROID_VERTICES_CROSS.push_back(v4);
-	ASTEROID_VERTICES_CROSS.push_back(v5);
-
-	v0.m_position = Vec3(-7.0f, -7.0f);
-	v1.m_position = Vec3(7.0f, -7.0f);
-	v2.m_position = Vec3(0.0f, 7.0f);
-	ASTEROID_VERTICES_MUSHROOM.push_back(v0);
-	ASTEROID_VERTICES_MUSHROOM.push_back(v1);
-	ASTEROID_VERTICES_MUSHROOM.push_back(v2);
-
-	v0.m_position = Vec3(-3.0f, -6.0f);
-	v1.m_position = Vec3(-6.0f, -3.0f);
-	v2.m_position = Vec3(-7.0f, 0.0f);
-	v3.m_position = Vec3(-6.0f, 3.0f);
-	v4.m_position = Vec3(-3.0f, 6.0f);
-	v5.m_position = Vec3(7.0f, 0.0f);
-	ASTEROID_VERTICES_TEXAS.push_back(v0);
-	ASTEROID_VERTICES_TEXAS.push_back(v1);
-	ASTEROID_VERTICES_TEXAS.push_back(v2);
-	ASTEROID_VERTICES_TEXAS.push_back(v3);
-	ASTEROID_VERTICES_TEXAS.push_back(v4);
-	ASTEROID_VERTICES_TEXAS.push_back(v5);
-
-	v0.m_position = Vec3(-7.0f, -7.0f);
-	v1.m_position = Vec3(-7.0f, 7.0f);
-	v2.m_position = Vec3(7.0f, 7.0f);
-	v3.m_position = Vec3(7.0f, -7.0f);
-	ASTEROID_VERTICES_TREE.push_back(v0);
-	ASTEROID_VERTICES_TREE.push_back(v1);
-	ASTEROID_VERTICES_TREE.push_back(v2);
-	ASTEROID_VERTICES_TREE.push_back(v3);
-
-
-	ASTEROID_VERTICES[0] = ASTEROID_VERTICES_CROSS;
-	ASTEROID_VERTICES[1] = ASTEROID_VERTICES_MUSHROOM;
-	ASTEROID_VERTICES[2] = ASTEROID_VERTICES_TEXAS;
-	ASTEROID_VERTICES[3] = ASTEROID_VERTICES_TREE;
+void AsteroidStore::RemoveAt(int index){
+	EntityStore::RemoveAt(index);
+
+	m_sizes[index] = m_sizes.back();
+	m_shapes[index] = m_shapes.back();
+	m_sizes.pop_back();
+	m_shapes.pop_back();
 }
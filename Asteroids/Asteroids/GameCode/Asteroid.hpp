@@ -8,10 +8,17 @@
 #ifndef __included_Asteroid__
 #define __included_Asteroid__
 
-#include "GameEntity.hpp"
+#include "EntityStore.hpp"
+class RandomGenerator;
+#ifndef ASTEROIDS_HEADLESS
+#include "Engine/Renderer/Mesh.hpp"
+#endif
 class OpenGLRenderer;
 
-class Asteroid : public GameEntity{
+///=====================================================
+/// Shared asteroid constants and per-shape geometry; the per-asteroid state lives in AsteroidStore
+///=====================================================
+class Asteroid{
 public:
 	const static float BASE_ASTEROID_RADIUS;
 
@@ -24,31 +31,32 @@ public:
 		ASTEROID_SHAPE_CROSS,
 		ASTEROID_SHAPE_MUSHROOM,
 		ASTEROID_SHAPE_TREE,
-		ASTEROID_SHAPE_TEXAS
+		ASTEROID_SHAPE_TEXAS,
+		NUM_ASTEROID_SHAPES
 	};
 
-private:
-	AsteroidShape m_shape;
-	AsteroidSize m_size;
-
-	static std::vector<Vertex_Anim> ASTEROID_VERTICES_CROSS;
-	static std::vector<Vertex_Anim> ASTEROID_VERTICES_MUSHROOM;
-	static std::vector<Vertex_Anim> ASTEROID_VERTICES_TREE;
-	static std::vector<Vertex_Anim> ASTEROID_VERTICES_TEXAS;
-	static std::vector<Vertex_Anim> ASTEROID_VERTICES[4];
+#ifndef ASTEROIDS_HEADLESS
+	static void CreateVertices(AsteroidShape shape, std::vector<Vertex_Anim>& out_vertices);
+	static void CreateMesh(AsteroidShape shape, const OpenGLRenderer* renderer, EngineAndrew::Material& material, EngineAndrew::Mesh& out_mesh);
+#endif
+};
 
-	void CreateVerticesBasedOnShape() const;
-	
+///=====================================================
+/// 
+///=====================================================
+class AsteroidStore : public EntityStore{
 public:
-	Asteroid(const Vec2& position, AsteroidSize asteroidSize, const OpenGLRenderer& renderer, EngineAndrew::Material& material);
+	std::vector<Asteroid::AsteroidSize> m_sizes;
+	std::vector<Asteroid::AsteroidShape> m_shapes;
 
-	inline AsteroidSize GetSize() const { return m_size; }
-	inline const Vec2 GetVelocity() const{return m_physics.m_velocity;}
-	inline void SetVelocity(const Vec2& velocity){m_physics.m_velocity = velocity;}
+	AsteroidStore();
 
-	void Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld) const;
-};
+	void Reserve(int capacity);
+	void Clear();
 
-typedef std::vector<Asteroid*> Asteroids;
+	int Add(const Vec2& position, Asteroid::AsteroidSize asteroidSize, RandomGenerator& random);
+	void Reset(int index, const Vec2& position, Asteroid::AsteroidSize asteroidSize, RandomGenerator& random);
+	void RemoveAt(int index);
+};
 
 #endif
\ No newline at end of file
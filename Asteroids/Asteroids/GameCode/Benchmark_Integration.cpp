@@ -0,0 +1,104 @@
+//=====================================================
+// Benchmark_Integration.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "EntityStore.hpp"
+#include "RandomGenerator.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const Vec2 WORLD_SIZE(1600.0f, 900.0f);
+static const float TICK_SECONDS = 1.0f / 60.0f;
+
+///=====================================================
+/// 
+///=====================================================
+static void FillStore(EntityStore& store, int numEntities, unsigned int seed){
+	RandomGenerator random(seed);
+	store.Clear();
+	store.Reserve(numEntities);
+
+	for (int entityIndex = 0; entityIndex < numEntities; ++entityIndex){
+		Vec2 position(random.GetFloatInRange(0.0f, WORLD_SIZE.x), random.GetFloatInRange(0.0f, WORLD_SIZE.y));
+		Vec2 velocity(random.GetFloatInRange(-300.0f, 300.0f), random.GetFloatInRange(-300.0f, 300.0f));
+		float orientationDegrees = random.GetFloatInRange(0.0f, 360.0f);
+		float angularVelocity = random.GetFloatInRange(-40.0f, 40.0f);
+		float radius = random.GetFloatInRange(0.6f, 19.5f);
+
+		store.Add(position, velocity, orientationDegrees, angularVelocity, radius);
+	}
+}
+
+///=====================================================
+/// Returns the number of entities whose state differs at all between the two stores
+///=====================================================
+static int CountMismatches(const EntityStore& first, const EntityStore& second){
+	int numMismatches = 0;
+	for (int index = 0; index < first.Size(); ++index){
+		if (memcmp(&first.m_positions[index], &second.m_positions[index], sizeof(Vec2)) != 0 ||
+			memcmp(&first.m_previousPositions[index], &second.m_previousPositions[index], sizeof(Vec2)) != 0 ||
+			memcmp(&first.m_orientationsDegrees[index], &second.m_orientationsDegrees[index], sizeof(float)) != 0){
+			++numMismatches;
+		}
+	}
+	return numMismatches;
+}
+
+///=====================================================
+/// 
+///=====================================================
+template <typename IntegrateFunction>
+static double TimeTicks(EntityStore& store, int numTicks, IntegrateFunction integrate){
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (int tick = 0; tick < numTicks; ++tick){
+		integrate(store);
+	}
+	std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+///=====================================================
+/// Compares EntityStore::IntegrateAndWrap against the scalar path on identical data
+///=====================================================
+int main(int argc, char* argv[]){
+	int numTicks = 1000;
+	if (argc > 1)
+		numTicks = atoi(argv[1]);
+	if (numTicks <= 0){
+		printf("Usage: %s [ticks]\n", argv[0]);
+		return 1;
+	}
+
+#ifdef ENTITYSTORE_USE_SSE2
+	printf("batched path: SSE2\n");
+#else
+	printf("batched path: scalar fallback\n");
+#endif
+	printf("%10s %14s %14s %9s %12s\n", "entities", "scalar ns/ent", "batched ns/ent", "speedup", "mismatches");
+
+	const int ENTITY_COUNTS[] = { 10000, 100000 };
+	int totalMismatches = 0;
+	for (int countIndex = 0; countIndex < (int)(sizeof(ENTITY_COUNTS) / sizeof(ENTITY_COUNTS[0])); ++countIndex){
+		int numEntities = ENTITY_COUNTS[countIndex];
+
+		EntityStore scalarStore;
+		EntityStore batchedStore;
+		FillStore(scalarStore, numEntities, 1);
+		FillStore(batchedStore, numEntities, 1);
+
+		double scalarSeconds = TimeTicks(scalarStore, numTicks, [](EntityStore& store){ store.IntegrateAndWrapScalar(TICK_SECONDS, WORLD_SIZE); });
+		double batchedSeconds = TimeTicks(batchedStore, numTicks, [](EntityStore& store){ store.IntegrateAndWrap(TICK_SECONDS, WORLD_SIZE); });
+
+		int numMismatches = CountMismatches(scalarStore, batchedStore);
+		totalMismatches += numMismatches;
+
+		double scale = 1.0e9 / ((double)numEntities * numTicks);
+		printf("%10d %14.3f %14.3f %8.2fx %12d\n", numEntities, scalarSeconds * scale, batchedSeconds * scale, scalarSeconds / batchedSeconds, numMismatches);
+	}
+
+	return (totalMismatches == 0) ? 0 : 2;
+}
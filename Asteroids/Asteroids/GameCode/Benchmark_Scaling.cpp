@@ -0,0 +1,283 @@
+//=====================================================
+// Benchmark_Scaling.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "World.hpp"
+#include "JobSystem.hpp"
+#include "RandomGenerator.hpp"
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const Vec2 BASE_WORLD_SIZE(1600.0f, 900.0f);
+static const int ENTITIES_PER_BASE_WORLD = 1000;
+static const int WARMUP_TICKS = 30;
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+///=====================================================
+/// Per-tick samples of one phase, in seconds
+///=====================================================
+struct PhaseStats{
+	double m_meanSeconds;
+	double m_p50Seconds;
+	double m_p99Seconds;
+	double m_maxSeconds;
+
+	PhaseStats() :
+		m_meanSeconds(0.0),
+		m_p50Seconds(0.0),
+		m_p99Seconds(0.0),
+		m_maxSeconds(0.0){
+	}
+};
+
+///=====================================================
+///
+///=====================================================
+struct ScenarioResult{
+	int m_targetEntities;
+	Vec2 m_worldSize;
+	double m_spawnNanosecondsPerAsteroid;
+	double m_meanAsteroids;
+	double m_meanBullets;
+	PhaseStats m_update;
+	PhaseStats m_integrate;
+	PhaseStats m_collision;
+	PhaseStats m_spawn;
+	unsigned int m_stateChecksum;
+};
+
+///=====================================================
+/// Nearest-rank percentiles, so every reported value is a real sample
+///=====================================================
+static PhaseStats CalcPhaseStats(std::vector<double>& samples){
+	PhaseStats stats;
+	if (samples.empty())
+		return stats;
+
+	std::sort(samples.begin(), samples.end());
+
+	double totalSeconds = 0.0;
+	for (std::vector<double>::const_iterator sampleIter = samples.begin(); sampleIter != samples.end(); ++sampleIter){
+		totalSeconds += *sampleIter;
+	}
+
+	int numSamples = (int)samples.size();
+	stats.m_meanSeconds = totalSeconds / numSamples;
+	stats.m_p50Seconds = samples[(int)ceil(0.50 * numSamples) - 1];
+	stats.m_p99Seconds = samples[(int)ceil(0.99 * numSamples) - 1];
+	stats.m_maxSeconds = samples.back();
+	return stats;
+}
+
+///=====================================================
+/// Tops the scene back up to the target counts, as asteroids are shot and bullets expire
+/// Bullets that hit something keep their pool slot until they would have expired, so the bullet count can stay short of the target
+///=====================================================
+static void Refill(World& world, RandomGenerator& random, const Vec2& worldSize, int targetEntities){
+	while (world.GetNumAsteroids() < targetEntities){
+		world.SpawnAsteroid();
+	}
+
+	for (int numBullets = world.GetNumBullets(); numBullets < targetEntities; ++numBullets){
+		Vec2 position(random.GetFloatInRange(0.0f, worldSize.x), random.GetFloatInRange(0.0f, worldSize.y));
+		world.SpawnBulletAt(position, random.GetFloatInRange(0.0f, 360.0f));
+		if (world.GetNumBullets() == numBullets) break; //pool is full
+	}
+}
+
+///=====================================================
+/// Builds a world with targetEntities asteroids and bullets and times every phase of numTicks ticks
+/// Past ENTITIES_PER_BASE_WORLD the world grows with the entity count, so density stays fixed and the timings show per-entity scaling rather than crowding
+///=====================================================
+static ScenarioResult RunScenario(int targetEntities, int numTicks, unsigned int seed, JobSystem* jobSystem){
+	ScenarioResult result;
+	result.m_targetEntities = targetEntities;
+	result.m_worldSize = BASE_WORLD_SIZE * sqrtf((float)std::max(1, targetEntities / ENTITIES_PER_BASE_WORLD));
+
+	World world(result.m_worldSize, nullptr, seed, jobSystem, targetEntities);
+	RandomGenerator random(seed);
+
+	BenchmarkClock::time_point spawnStartTime = BenchmarkClock::now();
+	int numAsteroidsBefore = world.GetNumAsteroids();
+	Refill(world, random, result.m_worldSize, targetEntities);
+	double spawnSeconds = std::chrono::duration<double>(BenchmarkClock::now() - spawnStartTime).count();
+	result.m_spawnNanosecondsPerAsteroid = 1.0e9 * spawnSeconds / std::max(1, world.GetNumAsteroids() - numAsteroidsBefore);
+
+	std::vector<double> updateSamples;
+	std::vector<double> integrateSamples;
+	std::vector<double> collisionSamples;
+	std::vector<double> spawnSamples;
+	updateSamples.reserve(numTicks);
+	integrateSamples.reserve(numTicks);
+	collisionSamples.reserve(numTicks);
+	spawnSamples.reserve(numTicks);
+
+	double totalAsteroids = 0.0;
+	double totalBullets = 0.0;
+	for (int tick = -WARMUP_TICKS; tick < numTicks; ++tick){
+		world.RespawnShip();
+		world.Update(World::SIMULATION_TICK_SECONDS);
+		s_theFrameArena->Reset();
+
+		BenchmarkClock::time_point refillStartTime = BenchmarkClock::now();
+		Refill(world, random, result.m_worldSize, targetEntities);
+		double refillSeconds = std::chrono::duration<double>(BenchmarkClock::now() - refillStartTime).count();
+
+		if (tick < 0) continue;
+
+		const WorldPhaseTimes& phaseTimes = world.GetLastPhaseTimes();
+		updateSamples.push_back(phaseTimes.m_updateSeconds);
+		integrateSamples.push_back(phaseTimes.m_integrateSeconds);
+		collisionSamples.push_back(phaseTimes.m_collisionSeconds);
+		spawnSamples.push_back(refillSeconds);
+
+		totalAsteroids += world.GetNumAsteroids();
+		totalBullets += world.GetNumBullets();
+	}
+
+	result.m_update = CalcPhaseStats(updateSamples);
+	result.m_integrate = CalcPhaseStats(integrateSamples);
+	result.m_collision = CalcPhaseStats(collisionSamples);
+	result.m_spawn = CalcPhaseStats(spawnSamples);
+	result.m_meanAsteroids = totalAsteroids / numTicks;
+	result.m_meanBullets = totalBullets / numTicks;
+	result.m_stateChecksum = world.CalcStateChecksum();
+	return result;
+}
+
+///=====================================================
+///
+///=====================================================
+static void PrintPhase(const char* phaseName, const PhaseStats& stats){
+	printf("  %-10s %10.4f %10.4f %10.4f %10.4f\n", phaseName, stats.m_meanSeconds * 1000.0, stats.m_p50Seconds * 1000.0, stats.m_p99Seconds * 1000.0, stats.m_maxSeconds * 1000.0);
+}
+
+///=====================================================
+///
+///=====================================================
+static void WritePhaseJson(FILE* file, const char* phaseName, const PhaseStats& stats, bool isLast){
+	fprintf(file, "        \"%s\": { \"mean_ms\": %.6f, \"p50_ms\": %.6f, \"p99_ms\": %.6f, \"max_ms\": %.6f }%s\n", phaseName,
+		stats.m_meanSeconds * 1000.0, stats.m_p50Seconds * 1000.0, stats.m_p99Seconds * 1000.0, stats.m_maxSeconds * 1000.0, isLast ? "" : ",");
+}
+
+///=====================================================
+/// Draw isn't listed since it can't run without a renderer; World::GetLastPhaseTimes reports it in the game
+///=====================================================
+static bool WriteJson(const char* fileName, const std::vector<ScenarioResult>& results, int numTicks, unsigned int seed, int numThreads){
+	FILE* file = fopen(fileName, "w");
+	if (file == nullptr)
+		return false;
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"benchmark\": \"AsteroidsScalingBench\",\n");
+	fprintf(file, "  \"ticks\": %d,\n", numTicks);
+	fprintf(file, "  \"warmup_ticks\": %d,\n", WARMUP_TICKS);
+	fprintf(file, "  \"seed\": %u,\n", seed);
+	fprintf(file, "  \"threads\": %d,\n", numThreads);
+	fprintf(file, "  \"scenarios\": [\n");
+
+	for (size_t resultIndex = 0; resultIndex < results.size(); ++resultIndex){
+		const ScenarioResult& result = results[resultIndex];
+		fprintf(file, "    {\n");
+		fprintf(file, "      \"target_entities\": %d,\n", result.m_targetEntities);
+		fprintf(file, "      \"world_size\": [%.1f, %.1f],\n", result.m_worldSize.x, result.m_worldSize.y);
+		fprintf(file, "      \"mean_asteroids\": %.1f,\n", result.m_meanAsteroids);
+		fprintf(file, "      \"mean_bullets\": %.1f,\n", result.m_meanBullets);
+		fprintf(file, "      \"spawn_asteroid_ns\": %.3f,\n", result.m_spawnNanosecondsPerAsteroid);
+		fprintf(file, "      \"state_checksum\": \"0x%08x\",\n", result.m_stateChecksum);
+		fprintf(file, "      \"phases\": {\n");
+		WritePhaseJson(file, "update", result.m_update, false);
+		WritePhaseJson(file, "integrate", result.m_integrate, false);
+		WritePhaseJson(file, "collision", result.m_collision, false);
+		WritePhaseJson(file, "spawn", result.m_spawn, true);
+		fprintf(file, "      }\n");
+		fprintf(file, "    }%s\n", (resultIndex + 1 < results.size()) ? "," : "");
+	}
+
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+	fclose(file);
+	return true;
+}
+
+///=====================================================
+///
+///=====================================================
+static void PrintUsage(const char* programName){
+	printf("Usage: %s [--ticks N] [--seed N] [--threads N] [--json FILE]\n", programName);
+	printf("  --ticks N       timed ticks per scene, after %d warmup ticks (default 300)\n", WARMUP_TICKS);
+	printf("  --seed N        random seed for every scene (default 1)\n");
+	printf("  --threads N     worker threads besides the main one; -1 picks one per core (default 0)\n");
+	printf("  --json FILE     also write the results as JSON, for comparing commits\n");
+}
+
+///=====================================================
+/// Times each phase of World::Update with 100 to 100k asteroids and bullets
+///=====================================================
+int main(int argc, char* argv[]){
+	int numTicks = 300;
+	unsigned int seed = 1;
+	int numWorkerThreads = 0;
+	const char* jsonFileName = nullptr;
+
+	for (int argIndex = 1; argIndex < argc; ++argIndex){
+		if (strcmp(argv[argIndex], "--ticks") == 0 && argIndex + 1 < argc){
+			numTicks = atoi(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--seed") == 0 && argIndex + 1 < argc){
+			seed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		}
+		else if (strcmp(argv[argIndex], "--threads") == 0 && argIndex + 1 < argc){
+			numWorkerThreads = atoi(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--json") == 0 && argIndex + 1 < argc){
+			jsonFileName = argv[++argIndex];
+		}
+		else{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (numTicks <= 0){
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	FrameArena frameArena;
+	s_theFrameArena = &frameArena;
+
+	std::unique_ptr<JobSystem> jobSystem((numWorkerThreads != 0) ? new JobSystem(numWorkerThreads) : nullptr);
+	int numThreads = (jobSystem != nullptr) ? jobSystem->GetNumThreads() : 1;
+
+	const int ENTITY_COUNTS[] = { 100, 1000, 10000, 100000 };
+	std::vector<ScenarioResult> results;
+	for (int countIndex = 0; countIndex < (int)(sizeof(ENTITY_COUNTS) / sizeof(ENTITY_COUNTS[0])); ++countIndex){
+		ScenarioResult result = RunScenario(ENTITY_COUNTS[countIndex], numTicks, seed, jobSystem.get());
+		results.push_back(result);
+
+		printf("%d asteroids + %d bullets in %.0fx%.0f (mean %.0f + %.0f), %.1f ns per SpawnAsteroid, checksum 0x%08x\n", result.m_targetEntities, result.m_targetEntities,
+			result.m_worldSize.x, result.m_worldSize.y, result.m_meanAsteroids, result.m_meanBullets, result.m_spawnNanosecondsPerAsteroid, result.m_stateChecksum);
+		printf("  %-10s %10s %10s %10s %10s\n", "phase (ms)", "mean", "p50", "p99", "max");
+		PrintPhase("update", result.m_update);
+		PrintPhase("integrate", result.m_integrate);
+		PrintPhase("collision", result.m_collision);
+		PrintPhase("spawn", result.m_spawn);
+	}
+
+	if (jsonFileName != nullptr && !WriteJson(jsonFileName, results, numTicks, seed, numThreads)){
+		printf("Failed to write %s\n", jsonFileName);
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
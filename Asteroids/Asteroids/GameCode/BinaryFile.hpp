@@ -0,0 +1,44 @@
+//=====================================================
+// BinaryFile.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_BinaryFile__
+#define __included_BinaryFile__
+
+#include <fstream>
+
+///=====================================================
+/// Raw native-endian values, for files only this build reads back (recordings, program binaries)
+///=====================================================
+template <typename T>
+inline void WriteValue(std::ofstream& file, const T& value){
+	file.write((const char*)&value, sizeof(T));
+}
+
+///=====================================================
+/// 
+///=====================================================
+template <typename T>
+inline bool ReadValue(std::ifstream& file, T& out_value){
+	file.read((char*)&out_value, sizeof(T));
+	return file.good();
+}
+
+///=====================================================
+/// Bytes between the read position and the end of the file, or -1 if the file can't tell
+/// Check lengths read from a file against this before allocating for them
+///=====================================================
+inline std::streamoff GetRemainingBytes(std::ifstream& file){
+	std::streamoff position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff end = file.tellg();
+	file.seekg(position);
+	if (position < 0 || end < position || !file.good())
+		return -1;
+	return end - position;
+}
+
+#endif
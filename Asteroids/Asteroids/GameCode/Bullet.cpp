@@ -4,28 +4,113 @@
 //=====================================================
 
 #include "Bullet.hpp"
-#include "Engine/Time/Time.hpp"
+#include "Engine/Core/Assert.hpp"
+#ifndef ASTEROIDS_HEADLESS
+#include "Engine/Renderer/Material.hpp"
+#endif
 
+const float Bullet::BULLET_RADIUS = 0.6f;
+const float Bullet::BULLET_SPEED = 300.0f;
+const double Bullet::BULLET_LIFETIME_SECONDS = 2.0;
+const int Bullet::MAX_BULLETS = 2048;
+
+#ifndef ASTEROIDS_HEADLESS
 ///=====================================================
 /// 
 ///=====================================================
-Bullet::Bullet(const Vec2& position, float shipOrientation, const OpenGLRenderer& renderer, EngineAndrew::Material& material) :
-GameEntity(position,  renderer, material),
-m_spawnTime(GetCurrentSeconds()){
+void Bullet::CreateVertices(std::vector<Vertex_Anim>& out_vertices){
 	Vertex_Anim v0(Vec3(0.0f, -0.6f, 0.0f));
 	Vertex_Anim v1(Vec3(0.6f, 0.0f, 0.0f));
 	Vertex_Anim v2(Vec3(0.0f, 0.6f, 0.0f));
 	Vertex_Anim v3(Vec3(-0.6f, 0.0f, 0.0f));
-	m_mesh.m_vertices.push_back(v0);
-	m_mesh.m_vertices.push_back(v1);
-	m_mesh.m_vertices.push_back(v2);
-	m_mesh.m_vertices.push_back(v3);
+	out_vertices.push_back(v0);
+	out_vertices.push_back(v1);
+	out_vertices.push_back(v2);
+	out_vertices.push_back(v3);
+}
+
+///=====================================================
+/// Every bullet looks the same, so the World builds one mesh with this and draws them all from it
+///=====================================================
+void Bullet::CreateMesh(const OpenGLRenderer* renderer, EngineAndrew::Material& material, EngineAndrew::Mesh& out_mesh){
+	out_mesh.Startup(renderer);
+	material.BindVertexData(out_mesh);
+
+	CreateVertices(out_mesh.m_vertices);
+	out_mesh.UseDefaultIndeces();
+	out_mesh.SendVertexDataToBuffer(renderer);
+}
+#endif
 
-	m_physics.m_orientationDegrees = shipOrientation;
-	m_physics.m_velocity.SetLengthAndHeadingDegrees(300.0f, shipOrientation);
+///=====================================================
+/// 
+///=====================================================
+BulletPool::BulletPool(int capacity) :
+EntityStore(),
+m_capacity(capacity),
+m_firstIndex(0),
+m_numAlive(0),
+m_spawnTimes(),
+m_isAlive(){
+	FATAL_ASSERT(capacity > 0);
+	EntityStore::Reserve(2 * capacity);
+	m_spawnTimes.reserve(2 * capacity);
+	m_isAlive.reserve(2 * capacity);
+}
 
-	m_radius = 0.6f;
+///=====================================================
+/// 
+///=====================================================
+void BulletPool::Clear(){
+	EntityStore::Clear();
+	m_spawnTimes.clear();
+	m_isAlive.clear();
+	m_firstIndex = 0;
+	m_numAlive = 0;
+}
 
-	m_mesh.UseDefaultIndeces();
-	m_mesh.SendVertexDataToBuffer(&renderer);
-}
\ No newline at end of file
+///=====================================================
+/// Returns the new bullet's index, or -1 if the window is full
+/// spawnTime must not be earlier than the last bullet's
+///=====================================================
+int BulletPool::Add(const Vec2& position, float orientationDegrees, double spawnTime){
+	if (IsFull())
+		return -1;
+	FATAL_ASSERT(m_spawnTimes.empty() || spawnTime >= m_spawnTimes.back());
+
+	//the window is below capacity, so this moves at most capacity bullets after at least capacity shots
+	if (Size() == 2 * m_capacity)
+		RemoveFront(m_firstIndex);
+
+	Vec2 velocity;
+	velocity.SetLengthAndHeadingDegrees(Bullet::BULLET_SPEED, orientationDegrees);
+
+	m_spawnTimes.push_back(spawnTime);
+	m_isAlive.push_back(1);
+	++m_numAlive;
+	return EntityStore::Add(position, velocity, orientationDegrees, 0.0f, Bullet::BULLET_RADIUS);
+}
+
+///=====================================================
+/// Drops expired bullets and tombstones from the front of the window; costs only the number dropped
+///=====================================================
+void BulletPool::ExpireSpawnedBefore(double minimumSpawnTime){
+	int numBullets = Size();
+	while (m_firstIndex < numBullets && (!m_isAlive[m_firstIndex] || m_spawnTimes[m_firstIndex] < minimumSpawnTime)){
+		Kill(m_firstIndex);
+		++m_firstIndex;
+	}
+
+	if (m_firstIndex == numBullets)
+		Clear();
+}
+
+///=====================================================
+/// Slides the window back to the start of storage
+///=====================================================
+void BulletPool::RemoveFront(int numBullets){
+	EntityStore::RemoveFront(numBullets);
+	m_spawnTimes.erase(m_spawnTimes.begin(), m_spawnTimes.begin() + numBullets);
+	m_isAlive.erase(m_isAlive.begin(), m_isAlive.begin() + numBullets);
+	m_firstIndex -= numBullets;
+}
@@ -8,20 +8,71 @@
 #ifndef __included_Bullet__
 #define __included_Bullet__
 
-#include "GameEntity.hpp"
+#include "EntityStore.hpp"
+#ifndef ASTEROIDS_HEADLESS
+#include "Engine/Renderer/Mesh.hpp"
+#endif
 class OpenGLRenderer;
-class Material;
 
-class Bullet : public GameEntity{
+///=====================================================
+/// Shared bullet constants and geometry; the per-bullet state lives in BulletPool
+///=====================================================
+class Bullet{
+public:
+	const static float BULLET_RADIUS;
+	const static float BULLET_SPEED;
+	const static double BULLET_LIFETIME_SECONDS;
+	const static int MAX_BULLETS;
+
+#ifndef ASTEROIDS_HEADLESS
+	static void CreateVertices(std::vector<Vertex_Anim>& out_vertices);
+	static void CreateMesh(const OpenGLRenderer* renderer, EngineAndrew::Material& material, EngineAndrew::Mesh& out_mesh);
+#endif
+};
+
+///=====================================================
+/// FIFO bullet queue: bullets are added at the back in spawn order and all share one lifetime, so they always expire from the front
+/// The live bullets are the contiguous window [GetFirstIndex(), Size()); expiry just advances the front of the window
+/// A bullet that hits something is killed in place and stays in the window as a tombstone until it reaches the front
+/// Storage is reserved at twice the capacity, so the window only slides back to index 0 once every capacity-or-more shots, never touching the heap
+///=====================================================
+class BulletPool : public EntityStore{
 private:
-	double m_spawnTime;
+	int m_capacity;
+	int m_firstIndex;
+	int m_numAlive;
+
+	//swap-and-pop would break the spawn order that expiry relies on
+	using EntityStore::RemoveAt;
+	void RemoveFront(int numBullets);
 
 public:
-	Bullet(const Vec2& position, float shipOrientation, const OpenGLRenderer& renderer, EngineAndrew::Material& material);
+	std::vector<double> m_spawnTimes;
+	std::vector<unsigned char> m_isAlive;
 
-	inline double GetSpawnTime() const{return m_spawnTime;}
+	explicit BulletPool(int capacity);
+
+	inline int GetCapacity() const{ return m_capacity; }
+	inline int GetFirstIndex() const{ return m_firstIndex; }
+	inline int GetNumAlive() const{ return m_numAlive; }
+	inline bool IsFull() const{ return Size() - m_firstIndex >= m_capacity; }
+
+	void Clear();
+
+	int Add(const Vec2& position, float orientationDegrees, double spawnTime);
+	inline void Kill(int index);
+	void ExpireSpawnedBefore(double minimumSpawnTime);
 };
 
-typedef std::vector<Bullet*> Bullets;
+
+///=====================================================
+/// 
+///=====================================================
+void BulletPool::Kill(int index){
+	if (m_isAlive[index]){
+		m_isAlive[index] = 0;
+		--m_numAlive;
+	}
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+//=====================================================
+// CollisionGrid.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "CollisionGrid.hpp"
+#include <algorithm>
+
+///=====================================================
+/// 
+///=====================================================
+CollisionGrid::CollisionGrid() :
+m_mins(0.0f, 0.0f),
+m_cellSize(1.0f),
+m_inverseCellSize(1.0f),
+m_numCellsX(1),
+m_numCellsY(1),
+m_cellStarts(2, 0),
+m_entityIndices(),
+m_entityCells(),
+m_writeCursors(){
+}
+
+///=====================================================
+/// 
+///=====================================================
+void CollisionGrid::Initialize(const Vec2& mins, const Vec2& maxs, float cellSize){
+	FATAL_ASSERT(cellSize > 0.0f);
+	FATAL_ASSERT(maxs.x > mins.x && maxs.y > mins.y);
+
+	m_mins = mins;
+	m_cellSize = cellSize;
+	m_inverseCellSize = 1.0f / cellSize;
+	m_numCellsX = (int)((maxs.x - mins.x) * m_inverseCellSize) + 1;
+	m_numCellsY = (int)((maxs.y - mins.y) * m_inverseCellSize) + 1;
+
+	m_cellStarts.assign(m_numCellsX * m_numCellsY + 1, 0);
+	m_entityIndices.clear();
+	m_entityCells.clear();
+}
+
+///=====================================================
+/// Rebuilds the whole grid from scratch; cheaper than moving entries between cells when almost everything moves every tick
+///=====================================================
+void CollisionGrid::Build(const Vec2* positions, int numPositions){
+	FATAL_ASSERT(numPositions == 0 || positions != nullptr);
+
+	std::fill(m_cellStarts.begin(), m_cellStarts.end(), 0);
+	m_entityCells.resize(numPositions);
+	m_entityIndices.resize(numPositions);
+
+	for (int entityIndex = 0; entityIndex < numPositions; ++entityIndex){
+		int cellIndex = GetCellY(positions[entityIndex].y) * m_numCellsX + GetCellX(positions[entityIndex].x);
+		m_entityCells[entityIndex] = cellIndex;
+		++m_cellStarts[cellIndex + 1];
+	}
+
+	for (size_t cellIndex = 1; cellIndex < m_cellStarts.size(); ++cellIndex){
+		m_cellStarts[cellIndex] += m_cellStarts[cellIndex - 1];
+	}
+
+	m_writeCursors.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+	for (int entityIndex = 0; entityIndex < numPositions; ++entityIndex){
+		m_entityIndices[m_writeCursors[m_entityCells[entityIndex]]++] = entityIndex;
+	}
+}
+
+///=====================================================
+/// Fills out_entityIndices with every entity whose cell overlaps the disc's bounds, sorted by entity index
+///=====================================================
+void CollisionGrid::QueryDisc(const Vec2& center, float radius, std::vector<int>& out_entityIndices) const{
+	out_entityIndices.clear();
+
+	int minCellX = GetCellX(center.x - radius);
+	int maxCellX = GetCellX(center.x + radius);
+	int minCellY = GetCellY(center.y - radius);
+	int maxCellY = GetCellY(center.y + radius);
+
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY){
+		for (int cellX = minCellX; cellX <= maxCellX; ++cellX){
+			int cellIndex = cellY * m_numCellsX + cellX;
+			for (int entry = m_cellStarts[cellIndex]; entry < m_cellStarts[cellIndex + 1]; ++entry){
+				out_entityIndices.push_back(m_entityIndices[entry]);
+			}
+		}
+	}
+
+	if (minCellX != maxCellX || minCellY != maxCellY)
+		std::sort(out_entityIndices.begin(), out_entityIndices.end());
+}
+
+
+///=====================================================
+/// Fills out_entityIndices with every entity whose cell overlaps the box, in cell order rather than sorted, e.g. for culling
+/// Only the overlapped cells are visited, so the cost follows the box's area and not the number of entities
+///=====================================================
+void CollisionGrid::QueryBox(const Vec2& mins, const Vec2& maxs, std::vector<int>& out_entityIndices) const{
+	out_entityIndices.clear();
+
+	int minCellX = GetCellX(mins.x);
+	int maxCellX = GetCellX(maxs.x);
+	int minCellY = GetCellY(mins.y);
+	int maxCellY = GetCellY(maxs.y);
+
+	for (int cellY = minCellY; cellY <= maxCellY; ++cellY){
+		//a row of cells is one contiguous run of entries
+		int firstEntry = m_cellStarts[cellY * m_numCellsX + minCellX];
+		int endEntry = m_cellStarts[cellY * m_numCellsX + maxCellX + 1];
+		out_entityIndices.insert(out_entityIndices.end(), m_entityIndices.begin() + firstEntry, m_entityIndices.begin() + endEntry);
+	}
+}
\ No newline at end of file
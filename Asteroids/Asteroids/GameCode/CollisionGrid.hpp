@@ -0,0 +1,67 @@
+//=====================================================
+// CollisionGrid.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_CollisionGrid__
+#define __included_CollisionGrid__
+
+#include <vector>
+#include "Engine/Math/Vec2.hpp"
+
+///=====================================================
+/// Uniform grid broadphase over a set of points.
+/// Entries are bucketed with a counting sort, so each cell is a contiguous run of entity indices in insertion order.
+/// Positions outside the grid bounds are clamped to the edge cells, so anything that has drifted past the
+/// screen edge and is waiting to wrap is still found.
+///=====================================================
+class CollisionGrid{
+private:
+	Vec2 m_mins;
+	float m_cellSize;
+	float m_inverseCellSize;
+	int m_numCellsX;
+	int m_numCellsY;
+
+	std::vector<int> m_cellStarts; //numCells + 1 entries, cell i owns [m_cellStarts[i], m_cellStarts[i + 1])
+	std::vector<int> m_entityIndices;
+	std::vector<int> m_entityCells;
+	std::vector<int> m_writeCursors;
+
+	inline int GetCellX(float x) const;
+	inline int GetCellY(float y) const;
+
+public:
+	CollisionGrid();
+
+	void Initialize(const Vec2& mins, const Vec2& maxs, float cellSize);
+	void Build(const Vec2* positions, int numPositions);
+	void QueryDisc(const Vec2& center, float radius, std::vector<int>& out_entityIndices) const;
+	void QueryBox(const Vec2& mins, const Vec2& maxs, std::vector<int>& out_entityIndices) const;
+
+	inline float GetCellSize() const{ return m_cellSize; }
+};
+
+///=====================================================
+/// 
+///=====================================================
+int CollisionGrid::GetCellX(float x) const{
+	int cellX = (int)((x - m_mins.x) * m_inverseCellSize);
+	if (cellX < 0) return 0;
+	if (cellX >= m_numCellsX) return m_numCellsX - 1;
+	return cellX;
+}
+
+///=====================================================
+/// 
+///=====================================================
+int CollisionGrid::GetCellY(float y) const{
+	int cellY = (int)((y - m_mins.y) * m_inverseCellSize);
+	if (cellY < 0) return 0;
+	if (cellY >= m_numCellsY) return m_numCellsY - 1;
+	return cellY;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+//=====================================================
+// EntityKernels.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_EntityKernels__
+#define __included_EntityKernels__
+
+#include "Asteroid.hpp"
+#include "Bullet.hpp"
+
+///=====================================================
+/// Compile-time description of one entity type whose components live in an EntityStore-derived set
+/// World's integrate and draw loops are templates over this, so each type gets its own loop with every call resolved and inlined
+/// A new entity type only needs its store and a specialization providing the same members as the ones below
+///=====================================================
+template <typename Store>
+struct EntityKernel;
+
+///=====================================================
+/// 
+///=====================================================
+template <>
+struct EntityKernel<AsteroidStore>{
+	//live entities are [GetFirstIndex, Size()), minus any IsAlive rejects
+	static inline int GetFirstIndex(const AsteroidStore& /*asteroids*/){ return 0; }
+	static inline bool IsAlive(const AsteroidStore& /*asteroids*/, int /*index*/){ return true; }
+
+	static inline float GetScale(const AsteroidStore& asteroids, int index){ return (float)asteroids.m_sizes[index]; }
+	//picks the mesh and instance batch
+	static inline int GetShapeIndex(const AsteroidStore& asteroids, int index){ return asteroids.m_shapes[index]; }
+};
+
+///=====================================================
+/// 
+///=====================================================
+template <>
+struct EntityKernel<BulletPool>{
+	static inline int GetFirstIndex(const BulletPool& bullets){ return bullets.GetFirstIndex(); }
+	static inline bool IsAlive(const BulletPool& bullets, int index){ return bullets.m_isAlive[index] != 0; }
+
+	static inline float GetScale(const BulletPool& /*bullets*/, int /*index*/){ return 1.0f; }
+	static inline int GetShapeIndex(const BulletPool& /*bullets*/, int /*index*/){ return 0; }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,221 @@
+//=====================================================
+// EntityStore.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "EntityStore.hpp"
+#ifdef ENTITYSTORE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+///=====================================================
+/// 
+///=====================================================
+EntityStore::EntityStore() :
+m_positions(),
+m_previousPositions(),
+m_velocities(),
+m_orientationsDegrees(),
+m_angularVelocities(),
+m_radii(){
+}
+
+///=====================================================
+/// 
+///=====================================================
+void EntityStore::Reserve(int capacity){
+	m_positions.reserve(capacity);
+	m_previousPositions.reserve(capacity);
+	m_velocities.reserve(capacity);
+	m_orientationsDegrees.reserve(capacity);
+	m_angularVelocities.reserve(capacity);
+	m_radii.reserve(capacity);
+}
+
+///=====================================================
+/// Keeps the allocated capacity so the store can refill without reallocating
+///=====================================================
+void EntityStore::Clear(){
+	m_positions.clear();
+	m_previousPositions.clear();
+	m_velocities.clear();
+	m_orientationsDegrees.clear();
+	m_angularVelocities.clear();
+	m_radii.clear();
+}
+
+///=====================================================
+/// 
+///=====================================================
+int EntityStore::Add(const Vec2& position, const Vec2& velocity, float orientationDegrees, float angularVelocity, float radius){
+	m_positions.push_back(position);
+	m_previousPositions.push_back(position);
+	m_velocities.push_back(velocity);
+	m_orientationsDegrees.push_back(orientationDegrees);
+	m_angularVelocities.push_back(angularVelocity);
+	m_radii.push_back(radius);
+
+	return Size() - 1;
+}
+
+///=====================================================
+/// O(1) swap-and-pop; the last entity takes over the removed index
+///=====================================================
+void EntityStore::RemoveAt(int index){
+	FATAL_ASSERT(index >= 0 && index < Size());
+	int lastIndex = Size() - 1;
+
+	m_positions[index] = m_positions[lastIndex];
+	m_previousPositions[index] = m_previousPositions[lastIndex];
+	m_velocities[index] = m_velocities[lastIndex];
+	m_orientationsDegrees[index] = m_orientationsDegrees[lastIndex];
+	m_angularVelocities[index] = m_angularVelocities[lastIndex];
+	m_radii[index] = m_radii[lastIndex];
+
+	m_positions.pop_back();
+	m_previousPositions.pop_back();
+	m_velocities.pop_back();
+	m_orientationsDegrees.pop_back();
+	m_angularVelocities.pop_back();
+	m_radii.pop_back();
+}
+
+///=====================================================
+/// Removes the first numEntities entities and shifts the rest down, keeping their order
+///=====================================================
+void EntityStore::RemoveFront(int numEntities){
+	FATAL_ASSERT(numEntities >= 0 && numEntities <= Size());
+
+	m_positions.erase(m_positions.begin(), m_positions.begin() + numEntities);
+	m_previousPositions.erase(m_previousPositions.begin(), m_previousPositions.begin() + numEntities);
+	m_velocities.erase(m_velocities.begin(), m_velocities.begin() + numEntities);
+	m_orientationsDegrees.erase(m_orientationsDegrees.begin(), m_orientationsDegrees.begin() + numEntities);
+	m_angularVelocities.erase(m_angularVelocities.begin(), m_angularVelocities.begin() + numEntities);
+	m_radii.erase(m_radii.begin(), m_radii.begin() + numEntities);
+}
+
+///=====================================================
+/// Advances the entities in [firstIndex,endIndex) by deltaSeconds, then wraps any that are a full radius outside [0,worldSize] to the opposite edge
+/// Uses SSE2 for all but the last few entities when available; the results are bit-identical to IntegrateAndWrapScalar
+/// Disjoint ranges touch disjoint memory, so they can run on different threads
+///=====================================================
+void EntityStore::IntegrateAndWrap(float deltaSeconds, const Vec2& worldSize, int firstIndex, int endIndex){
+	FATAL_ASSERT(firstIndex >= 0 && endIndex <= Size());
+#ifdef ENTITYSTORE_USE_SSE2
+	int firstRemainingIndex = IntegrateAndWrapSSE2(firstIndex, endIndex, deltaSeconds, worldSize);
+#else
+	int firstRemainingIndex = firstIndex;
+#endif
+	IntegrateAndWrapRange(firstRemainingIndex, endIndex, deltaSeconds, worldSize);
+}
+
+///=====================================================
+/// 
+///=====================================================
+void EntityStore::IntegrateAndWrapScalar(float deltaSeconds, const Vec2& worldSize){
+	IntegrateAndWrapRange(0, Size(), deltaSeconds, worldSize);
+}
+
+///=====================================================
+/// Same integration as Physics2D::Update; a wrapped entity also gets its previous position reset so it doesn't interpolate across the screen
+///=====================================================
+void EntityStore::IntegrateAndWrapRange(int firstIndex, int endIndex, float deltaSeconds, const Vec2& worldSize){
+	for (int index = firstIndex; index < endIndex; ++index){
+		Vec2& position = m_positions[index];
+		float radius = m_radii[index];
+
+		m_previousPositions[index] = position;
+		position += m_velocities[index] * deltaSeconds;
+		m_orientationsDegrees[index] += m_angularVelocities[index] * deltaSeconds;
+
+		bool didWrap = true;
+		if (position.x + radius < 0.0f){
+			position.x = worldSize.x + radius;
+		}
+		else if (position.x - radius > worldSize.x){
+			position.x = -radius;
+		}
+		else{
+			didWrap = false;
+		}
+
+		if (position.y + radius < 0.0f){
+			position.y = worldSize.y + radius;
+			didWrap = true;
+		}
+		else if (position.y - radius > worldSize.y){
+			position.y = -radius;
+			didWrap = true;
+		}
+
+		if (didWrap)
+			m_previousPositions[index] = position;
+	}
+}
+
+#ifdef ENTITYSTORE_USE_SSE2
+///=====================================================
+/// Integrates and wraps two interleaved (x,y) positions held in one register
+/// radius holds each entity's radius in both of its lanes
+///=====================================================
+static inline __m128 IntegrateAndWrapPair(__m128 position, __m128 velocity, __m128 radius, __m128 deltaSeconds, __m128 worldSize, __m128& out_previousPosition){
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	__m128 newPosition = _mm_add_ps(position, _mm_mul_ps(velocity, deltaSeconds));
+
+	//the two tests can't both pass, since worldSize and radius are never negative
+	__m128 isBelow = _mm_cmplt_ps(_mm_add_ps(newPosition, radius), zero);
+	__m128 isAbove = _mm_cmpgt_ps(_mm_sub_ps(newPosition, radius), worldSize);
+	__m128 didWrap = _mm_or_ps(isBelow, isAbove);
+
+	__m128 wrappedPosition = _mm_or_ps(_mm_and_ps(isBelow, _mm_add_ps(worldSize, radius)), _mm_and_ps(isAbove, _mm_xor_ps(radius, signMask)));
+	newPosition = _mm_or_ps(_mm_andnot_ps(didWrap, newPosition), wrappedPosition);
+
+	//an entity counts as wrapped if either of its axes did
+	__m128 didEntityWrap = _mm_or_ps(didWrap, _mm_shuffle_ps(didWrap, didWrap, _MM_SHUFFLE(2, 3, 0, 1)));
+	out_previousPosition = _mm_or_ps(_mm_andnot_ps(didEntityWrap, position), _mm_and_ps(didEntityWrap, newPosition));
+
+	return newPosition;
+}
+
+///=====================================================
+/// Handles entities four at a time and returns the index of the first one left for the scalar loop
+///=====================================================
+int EntityStore::IntegrateAndWrapSSE2(int firstIndex, int endIndex, float deltaSeconds, const Vec2& worldSize){
+	static_assert(sizeof(Vec2) == 2 * sizeof(float), "IntegrateAndWrapSSE2 reads Vec2 arrays as packed floats");
+
+	int batchEndIndex = firstIndex + ((endIndex - firstIndex) & ~3);
+	if (batchEndIndex == firstIndex)
+		return firstIndex;
+
+	const __m128 deltaSecondsX4 = _mm_set1_ps(deltaSeconds);
+	const __m128 worldSizeX2 = _mm_setr_ps(worldSize.x, worldSize.y, worldSize.x, worldSize.y);
+
+	float* positions = &m_positions[0].x;
+	float* previousPositions = &m_previousPositions[0].x;
+	const float* velocities = &m_velocities[0].x;
+	float* orientations = &m_orientationsDegrees[0];
+	const float* angularVelocities = &m_angularVelocities[0];
+	const float* radii = &m_radii[0];
+
+	for (int index = firstIndex; index < batchEndIndex; index += 4){
+		__m128 radius4 = _mm_loadu_ps(radii + index);
+		__m128 previousPosition;
+
+		__m128 position = IntegrateAndWrapPair(_mm_loadu_ps(positions + 2 * index), _mm_loadu_ps(velocities + 2 * index), _mm_unpacklo_ps(radius4, radius4), deltaSecondsX4, worldSizeX2, previousPosition);
+		_mm_storeu_ps(positions + 2 * index, position);
+		_mm_storeu_ps(previousPositions + 2 * index, previousPosition);
+
+		position = IntegrateAndWrapPair(_mm_loadu_ps(positions + 2 * index + 4), _mm_loadu_ps(velocities + 2 * index + 4), _mm_unpackhi_ps(radius4, radius4), deltaSecondsX4, worldSizeX2, previousPosition);
+		_mm_storeu_ps(positions + 2 * index + 4, position);
+		_mm_storeu_ps(previousPositions + 2 * index + 4, previousPosition);
+
+		__m128 orientation = _mm_add_ps(_mm_loadu_ps(orientations + index), _mm_mul_ps(_mm_loadu_ps(angularVelocities + index), deltaSecondsX4));
+		_mm_storeu_ps(orientations + index, orientation);
+	}
+
+	return batchEndIndex;
+}
+#endif
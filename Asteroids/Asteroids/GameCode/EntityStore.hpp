@@ -0,0 +1,58 @@
+//=====================================================
+// EntityStore.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_EntityStore__
+#define __included_EntityStore__
+
+#include <vector>
+#include "Engine/Math/Vec2.hpp"
+
+//SSE2 is guaranteed on x64 and enabled by /arch:SSE2 (the VS2015 default) on Win32
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ENTITYSTORE_USE_SSE2
+#endif
+
+///=====================================================
+/// Contiguous structure-of-arrays storage for many moving entities
+/// Every column has one entry per entity; removal swaps the last entity into the hole, so indices are not stable
+/// m_previousPositions holds each position from before the last integration, for interpolated drawing between ticks
+///=====================================================
+class EntityStore{
+public:
+	std::vector<Vec2> m_positions;
+	std::vector<Vec2> m_previousPositions;
+	std::vector<Vec2> m_velocities;
+	std::vector<float> m_orientationsDegrees;
+	std::vector<float> m_angularVelocities;
+	std::vector<float> m_radii;
+
+	EntityStore();
+
+	inline int Size() const{ return (int)m_positions.size(); }
+	inline bool IsEmpty() const{ return m_positions.empty(); }
+
+	inline Vec2 GetInterpolatedPosition(int index, float interpolationFraction) const{ return m_previousPositions[index] + (m_positions[index] - m_previousPositions[index]) * interpolationFraction; }
+
+	void Reserve(int capacity);
+	void Clear();
+
+	int Add(const Vec2& position, const Vec2& velocity, float orientationDegrees, float angularVelocity, float radius);
+	void RemoveAt(int index);
+	void RemoveFront(int numEntities);
+
+	inline void IntegrateAndWrap(float deltaSeconds, const Vec2& worldSize){ IntegrateAndWrap(deltaSeconds, worldSize, 0, Size()); }
+	void IntegrateAndWrap(float deltaSeconds, const Vec2& worldSize, int firstIndex, int endIndex);
+	void IntegrateAndWrapScalar(float deltaSeconds, const Vec2& worldSize);
+
+private:
+	void IntegrateAndWrapRange(int firstIndex, int endIndex, float deltaSeconds, const Vec2& worldSize);
+#ifdef ENTITYSTORE_USE_SSE2
+	int IntegrateAndWrapSSE2(int firstIndex, int endIndex, float deltaSeconds, const Vec2& worldSize);
+#endif
+};
+
+#endif
\ No newline at end of file
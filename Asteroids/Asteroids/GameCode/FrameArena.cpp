@@ -0,0 +1,78 @@
+//=====================================================
+// FrameArena.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "FrameArena.hpp"
+
+const size_t FrameArena::DEFAULT_INITIAL_BYTES = 256 * 1024;
+
+FrameArena* s_theFrameArena = nullptr;
+
+///=====================================================
+///
+///=====================================================
+FrameArena::FrameArena(size_t initialBytes) :
+m_block(nullptr),
+m_blockBytes(initialBytes),
+m_usedBytes(0),
+m_frameBytes(0),
+m_peakFrameBytes(0),
+m_overflowBlocks(),
+m_ownerThreadID(std::this_thread::get_id()){
+	if (m_blockBytes > 0)
+		m_block = new char[m_blockBytes];
+}
+
+///=====================================================
+///
+///=====================================================
+FrameArena::~FrameArena(){
+	Reset();
+	delete[] m_block;
+}
+
+///=====================================================
+/// alignment must be a power of two no larger than the heap's own, which every type a container holds here is
+///=====================================================
+void* FrameArena::Allocate(size_t numBytes, size_t alignment){
+	FATAL_ASSERT(std::this_thread::get_id() == m_ownerThreadID);
+	FATAL_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0 && alignment <= alignof(std::max_align_t));
+
+	size_t alignedOffset = (m_usedBytes + alignment - 1) & ~(alignment - 1);
+	m_frameBytes += numBytes;
+
+	if (alignedOffset + numBytes <= m_blockBytes){
+		m_usedBytes = alignedOffset + numBytes;
+		return m_block + alignedOffset;
+	}
+
+	char* overflowBlock = new char[(numBytes > 0) ? numBytes : 1];
+	m_overflowBlocks.push_back(overflowBlock);
+	return overflowBlock;
+}
+
+///=====================================================
+/// Everything allocated since the last Reset is invalid afterwards
+///=====================================================
+void FrameArena::Reset(){
+	FATAL_ASSERT(std::this_thread::get_id() == m_ownerThreadID);
+	if (m_frameBytes > m_peakFrameBytes)
+		m_peakFrameBytes = m_frameBytes;
+
+	if (!m_overflowBlocks.empty()){
+		for (std::vector<char*>::iterator blockIter = m_overflowBlocks.begin(); blockIter != m_overflowBlocks.end(); ++blockIter){
+			delete[] *blockIter;
+		}
+		m_overflowBlocks.clear();
+
+		//sized for the frame that overflowed plus alignment padding, so a repeat of it fits without touching the heap
+		delete[] m_block;
+		m_blockBytes = m_frameBytes + m_frameBytes / 4;
+		m_block = new char[m_blockBytes];
+	}
+
+	m_usedBytes = 0;
+	m_frameBytes = 0;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+//=====================================================
+// FrameArena.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_FrameArena__
+#define __included_FrameArena__
+
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <vector>
+
+///=====================================================
+/// Bump allocator for data that lives no longer than the current frame; Reset releases everything at once
+/// When a frame outgrows the block, overflow blocks come from the heap and the next Reset replaces the block with one big enough for that frame
+/// Main thread only
+///=====================================================
+class FrameArena{
+private:
+	char* m_block;
+	size_t m_blockBytes;
+	size_t m_usedBytes;
+	size_t m_frameBytes; //everything handed out this frame, including overflow
+	size_t m_peakFrameBytes;
+	std::vector<char*> m_overflowBlocks;
+	std::thread::id m_ownerThreadID;
+
+	FrameArena(const FrameArena&);
+	FrameArena& operator=(const FrameArena&);
+
+public:
+	const static size_t DEFAULT_INITIAL_BYTES;
+
+	explicit FrameArena(size_t initialBytes = DEFAULT_INITIAL_BYTES);
+	~FrameArena();
+
+	void* Allocate(size_t numBytes, size_t alignment);
+	void Reset();
+
+	inline size_t GetCapacity() const{ return m_blockBytes; }
+	inline size_t GetFrameBytes() const{ return m_frameBytes; }
+	inline size_t GetPeakFrameBytes() const{ return m_peakFrameBytes; }
+};
+
+extern FrameArena* s_theFrameArena;
+
+///=====================================================
+/// STL allocator over a FrameArena; deallocate is a no-op, since the memory goes back at Reset
+/// A null arena falls back to the heap, so code using these still runs where no arena was set up
+///=====================================================
+template <typename T>
+class FrameArenaAllocator{
+public:
+	typedef T value_type;
+
+	FrameArena* m_arena;
+
+	inline explicit FrameArenaAllocator(FrameArena* arena = s_theFrameArena) : m_arena(arena){}
+	template <typename U>
+	inline FrameArenaAllocator(const FrameArenaAllocator<U>& other) : m_arena(other.m_arena){}
+
+	inline T* allocate(size_t numElements);
+	inline void deallocate(T* elements, size_t numElements);
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameArenaAllocator<T> >;
+
+
+///=====================================================
+///
+///=====================================================
+template <typename T>
+T* FrameArenaAllocator<T>::allocate(size_t numElements){
+	if (m_arena == nullptr)
+		return static_cast<T*>(::operator new(numElements * sizeof(T)));
+	return static_cast<T*>(m_arena->Allocate(numElements * sizeof(T), alignof(T)));
+}
+
+///=====================================================
+///
+///=====================================================
+template <typename T>
+void FrameArenaAllocator<T>::deallocate(T* elements, size_t /*numElements*/){
+	if (m_arena == nullptr)
+		::operator delete(elements);
+}
+
+///=====================================================
+///
+///=====================================================
+template <typename T, typename U>
+inline bool operator==(const FrameArenaAllocator<T>& first, const FrameArenaAllocator<U>& second){
+	return first.m_arena == second.m_arena;
+}
+
+///=====================================================
+///
+///=====================================================
+template <typename T, typename U>
+inline bool operator!=(const FrameArenaAllocator<T>& first, const FrameArenaAllocator<U>& second){
+	return first.m_arena != second.m_arena;
+}
+
+#endif
\ No newline at end of file
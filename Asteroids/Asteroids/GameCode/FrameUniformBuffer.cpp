@@ -0,0 +1,95 @@
+//=====================================================
+// FrameUniformBuffer.cpp
+// by Andrew Socha
+//=====================================================
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include "Engine/Core/EngineCore.hpp"
+#include "FrameUniformBuffer.hpp"
+#include "GLExtensions.hpp"
+#include <cstring>
+
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+
+const GLuint FrameUniformBuffer::BINDING_POINT = 0;
+const char* FrameUniformBuffer::BLOCK_NAME = "FrameMatrices";
+
+///=====================================================
+/// 
+///=====================================================
+FrameUniformBuffer::FrameUniformBuffer() :
+m_bufferID(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+bool FrameUniformBuffer::LoadFunctions(){
+	GLExtensions::Load();
+	return GLExtensions::s_getUniformBlockIndex != nullptr && GLExtensions::s_uniformBlockBinding != nullptr && GLExtensions::s_bindBufferBase != nullptr;
+}
+
+///=====================================================
+/// Returns false if uniform buffers aren't supported
+///=====================================================
+bool FrameUniformBuffer::Startup(){
+	FATAL_ASSERT(m_bufferID == 0);
+	if (!LoadFunctions())
+		return false;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameMatrices), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	//the binding stays put for the buffer's lifetime, so every attached program sees each Update without rebinding
+	GLExtensions::s_bindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, m_bufferID);
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void FrameUniformBuffer::Shutdown(){
+	if (m_bufferID != 0){
+		GLExtensions::s_bindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, 0);
+		glDeleteBuffers(1, &m_bufferID);
+		m_bufferID = 0;
+	}
+}
+
+///=====================================================
+/// Call once per frame, before the first draw that reads FrameMatrices
+///=====================================================
+void FrameUniformBuffer::Update(const float* cameraToClip, const float* worldToCamera){
+	FATAL_ASSERT(IsRunning());
+
+	FrameMatrices matrices;
+	memcpy(matrices.m_cameraToClip, cameraToClip, sizeof(matrices.m_cameraToClip));
+	memcpy(matrices.m_worldToCamera, worldToCamera, sizeof(matrices.m_worldToCamera));
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_bufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameMatrices), &matrices);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+///=====================================================
+/// Points the program's FrameMatrices block at BINDING_POINT; returns false if the program has no such block
+///=====================================================
+bool FrameUniformBuffer::AttachProgram(GLuint programID){
+	if (!LoadFunctions())
+		return false;
+
+	GLuint blockIndex = GLExtensions::s_getUniformBlockIndex(programID, BLOCK_NAME);
+	if (blockIndex == GL_INVALID_INDEX)
+		return false;
+
+	GLExtensions::s_uniformBlockBinding(programID, blockIndex, BINDING_POINT);
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+//=====================================================
+// FrameUniformBuffer.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_FrameUniformBuffer__
+#define __included_FrameUniformBuffer__
+
+#include "Engine/Renderer/OpenGLRenderer.hpp"
+
+///=====================================================
+/// The matrices every draw in a frame shares, in one std140 uniform buffer read through the FrameMatrices block of the FRAME_UNIFORMS shader variants
+/// Update uploads them once per frame; programs attached to BINDING_POINT then draw without setting any per-frame uniforms
+///=====================================================
+class FrameUniformBuffer{
+private:
+	//std140 layout of FrameMatrices; a mat4 is four vec4 columns, so column-major float[16] needs no padding
+	struct FrameMatrices{
+		float m_cameraToClip[16];
+		float m_worldToCamera[16];
+	};
+
+	GLuint m_bufferID;
+
+	static bool LoadFunctions();
+
+public:
+	const static GLuint BINDING_POINT;
+	const static char* BLOCK_NAME;
+
+	FrameUniformBuffer();
+
+	bool Startup();
+	void Shutdown();
+	inline bool IsRunning() const{ return m_bufferID != 0; }
+
+	void Update(const float* cameraToClip, const float* worldToCamera);
+
+	static bool AttachProgram(GLuint programID);
+};
+
+#endif
\ No newline at end of file
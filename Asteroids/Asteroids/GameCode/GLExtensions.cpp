@@ -0,0 +1,42 @@
+//=====================================================
+// GLExtensions.cpp
+// by Andrew Socha
+//=====================================================
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include "Engine/Core/EngineCore.hpp"
+#include "GLExtensions.hpp"
+
+GLExtensions::VertexAttribDivisorFunction GLExtensions::s_vertexAttribDivisor = nullptr;
+GLExtensions::DrawArraysInstancedFunction GLExtensions::s_drawArraysInstanced = nullptr;
+GLExtensions::GetUniformBlockIndexFunction GLExtensions::s_getUniformBlockIndex = nullptr;
+GLExtensions::UniformBlockBindingFunction GLExtensions::s_uniformBlockBinding = nullptr;
+GLExtensions::BindBufferBaseFunction GLExtensions::s_bindBufferBase = nullptr;
+GLExtensions::BindFragDataLocationFunction GLExtensions::s_bindFragDataLocation = nullptr;
+GLExtensions::ProgramParameteriFunction GLExtensions::s_programParameteri = nullptr;
+GLExtensions::GetProgramBinaryFunction GLExtensions::s_getProgramBinary = nullptr;
+GLExtensions::ProgramBinaryFunction GLExtensions::s_programBinary = nullptr;
+
+bool GLExtensions::s_isLoaded = false;
+
+///=====================================================
+/// 
+///=====================================================
+void GLExtensions::Load(){
+	if (s_isLoaded)
+		return;
+	s_isLoaded = true;
+
+	s_vertexAttribDivisor = (VertexAttribDivisorFunction)wglGetProcAddress("glVertexAttribDivisor");
+	s_drawArraysInstanced = (DrawArraysInstancedFunction)wglGetProcAddress("glDrawArraysInstanced");
+
+	s_getUniformBlockIndex = (GetUniformBlockIndexFunction)wglGetProcAddress("glGetUniformBlockIndex");
+	s_uniformBlockBinding = (UniformBlockBindingFunction)wglGetProcAddress("glUniformBlockBinding");
+	s_bindBufferBase = (BindBufferBaseFunction)wglGetProcAddress("glBindBufferBase");
+
+	s_bindFragDataLocation = (BindFragDataLocationFunction)wglGetProcAddress("glBindFragDataLocation");
+	s_programParameteri = (ProgramParameteriFunction)wglGetProcAddress("glProgramParameteri");
+	s_getProgramBinary = (GetProgramBinaryFunction)wglGetProcAddress("glGetProgramBinary");
+	s_programBinary = (ProgramBinaryFunction)wglGetProcAddress("glProgramBinary");
+}
@@ -0,0 +1,49 @@
+//=====================================================
+// GLExtensions.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_GLExtensions__
+#define __included_GLExtensions__
+
+#include "Engine/Renderer/OpenGLRenderer.hpp"
+
+///=====================================================
+/// GL entry points past the renderer's core set (instancing, uniform buffers, program binaries), fetched together on first use
+/// Any of them may be null on older drivers; callers check the ones they need and fall back without them
+///=====================================================
+class GLExtensions{
+public:
+	typedef void (APIENTRY *VertexAttribDivisorFunction)(GLuint index, GLuint divisor);
+	typedef void (APIENTRY *DrawArraysInstancedFunction)(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+	typedef GLuint (APIENTRY *GetUniformBlockIndexFunction)(GLuint program, const GLchar* uniformBlockName);
+	typedef void (APIENTRY *UniformBlockBindingFunction)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+	typedef void (APIENTRY *BindBufferBaseFunction)(GLenum target, GLuint index, GLuint buffer);
+	typedef void (APIENTRY *BindFragDataLocationFunction)(GLuint program, GLuint colorNumber, const GLchar* name);
+	typedef void (APIENTRY *ProgramParameteriFunction)(GLuint program, GLenum parameterName, GLint value);
+	typedef void (APIENTRY *GetProgramBinaryFunction)(GLuint program, GLsizei bufferSize, GLsizei* out_length, GLenum* out_binaryFormat, void* out_binary);
+	typedef void (APIENTRY *ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+	//GL 3.3 / ARB_instanced_arrays
+	static VertexAttribDivisorFunction s_vertexAttribDivisor;
+	static DrawArraysInstancedFunction s_drawArraysInstanced;
+	//GL 3.1 / ARB_uniform_buffer_object
+	static GetUniformBlockIndexFunction s_getUniformBlockIndex;
+	static UniformBlockBindingFunction s_uniformBlockBinding;
+	static BindBufferBaseFunction s_bindBufferBase;
+	//GL 4.1 / ARB_get_program_binary, plus the GL 3.0 fragment output binding
+	static BindFragDataLocationFunction s_bindFragDataLocation;
+	static ProgramParameteriFunction s_programParameteri;
+	static GetProgramBinaryFunction s_getProgramBinary;
+	static ProgramBinaryFunction s_programBinary;
+
+	//needs a current GL context; only fetches once
+	static void Load();
+
+private:
+	static bool s_isLoaded;
+};
+
+#endif
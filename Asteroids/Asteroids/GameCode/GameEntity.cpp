@@ -4,36 +4,41 @@
 //=====================================================
 
 #include "GameEntity.hpp"
+#ifndef ASTEROIDS_HEADLESS
 #include "Engine\Renderer\Material.hpp"
+#endif
 
 
 ///=====================================================
-/// 
+/// renderer and material may be null to run without graphics
 ///=====================================================
-GameEntity::GameEntity(const Vec2& position, const OpenGLRenderer& renderer, EngineAndrew::Material& material) :
+GameEntity::GameEntity(const Vec2& position, const OpenGLRenderer* renderer, EngineAndrew::Material* material) :
 m_physics(),
+m_previousPosition(position),
 m_radius(0.0f){
 	m_physics.m_position = position;
 
-	m_mesh.Startup(&renderer);
-	material.BindVertexData(m_mesh);
+#ifndef ASTEROIDS_HEADLESS
+	if (renderer != nullptr && material != nullptr){
+		m_mesh.Startup(renderer);
+		material->BindVertexData(m_mesh);
+	}
+#else
+	(void)renderer;
+	(void)material;
+#endif
 }
 
+#ifndef ASTEROIDS_HEADLESS
 ///=====================================================
-/// 
+/// interpolationFraction is how far the frame is between the previous tick and the current one
 ///=====================================================
-void GameEntity::Update(double deltaSeconds, const OpenGLRenderer& /*renderer*/){
-	m_physics.Update((float)deltaSeconds);
-}
-
-///=====================================================
-/// 
-///=====================================================
-void GameEntity::Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld) const {
+void GameEntity::Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld, float interpolationFraction) const {
 	FATAL_ASSERT(objectToWorld != nullptr);
 	Matrix4 modelMatrix = Matrix4::CreateRotationDegreesAboutZ(m_physics.m_orientationDegrees);
-	modelMatrix.Translate(m_physics.m_position);
+	modelMatrix.Translate(GetInterpolatedPosition(interpolationFraction));
 	objectToWorld->m_data[0] = modelMatrix;
 
 	material.Render(m_mesh);
 }
+#endif
@@ -11,25 +11,48 @@
 struct Vec2;
 #include "Engine/Physics/Physics2D.hpp"
 class OpenGLRenderer;
+#ifndef ASTEROIDS_HEADLESS
 #include "Engine/Renderer/Mesh.hpp"
-class Material;
+#endif
+namespace EngineAndrew{ class Material; }
 
+///=====================================================
+/// Shared state and behavior for the few one-off entities, like the ship, that don't live in an EntityStore
+/// Not polymorphic: subclasses shadow Update and Draw and are always used through their own type, so every call is resolved at compile time
+///=====================================================
 class GameEntity{
 protected:
 	Physics2D m_physics;
+	Vec2 m_previousPosition;
 	float m_radius;
+#ifndef ASTEROIDS_HEADLESS
 	EngineAndrew::Mesh m_mesh;
+#endif
 
 public:
-	GameEntity(const Vec2& position, const OpenGLRenderer& renderer, EngineAndrew::Material& material);
+	GameEntity(const Vec2& position, const OpenGLRenderer* renderer, EngineAndrew::Material* material);
 
 	inline const Vec2& GetPosition() const{return m_physics.m_position;}
 	inline float GetRadius() const{return m_radius;}
 
-	inline void SetPosition(const Vec2& position){m_physics.m_position = position;}
+	inline Vec2 GetInterpolatedPosition(float interpolationFraction) const{return m_previousPosition + (m_physics.m_position - m_previousPosition) * interpolationFraction;}
 
-	virtual void Update(double deltaSeconds, const OpenGLRenderer& renderer);
-	virtual void Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld) const;
+	//moves without interpolating from the old position, e.g. when wrapping around the screen
+	inline void SetPosition(const Vec2& position){m_physics.m_position = position; m_previousPosition = position;}
+
+	inline void Update(double deltaSeconds, const OpenGLRenderer* renderer);
+#ifndef ASTEROIDS_HEADLESS
+	void Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld, float interpolationFraction) const;
+#endif
 };
 
+
+///=====================================================
+/// 
+///=====================================================
+void GameEntity::Update(double deltaSeconds, const OpenGLRenderer* /*renderer*/){
+	m_previousPosition = m_physics.m_position;
+	m_physics.Update((float)deltaSeconds);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+//=====================================================
+// InputRecorder.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "InputRecorder.hpp"
+#include "BinaryFile.hpp"
+#include <cmath>
+#include <fstream>
+
+static const unsigned int RECORDING_FILE_ID = 0x52495341; //"ASIR"
+static const unsigned int RECORDING_FILE_VERSION = 1;
+
+///=====================================================
+/// 
+///=====================================================
+InputRecorder::InputRecorder() :
+m_state(RECORDER_IDLE),
+m_seed(0),
+m_tickSeconds(0.0),
+m_finalChecksum(0),
+m_runs(),
+m_numTicks(0),
+m_replayRunIndex(0),
+m_replayTickInRun(0),
+m_numReplayedTicks(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+void InputRecorder::StartRecording(unsigned int seed, double tickSeconds){
+	m_state = RECORDER_RECORDING;
+	m_seed = seed;
+	m_tickSeconds = tickSeconds;
+	m_finalChecksum = 0;
+	m_runs.clear();
+	m_numTicks = 0;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void InputRecorder::RecordTick(const TickInput& input){
+	FATAL_ASSERT(m_state == RECORDER_RECORDING);
+
+	if (!m_runs.empty() && m_runs.back().m_input == input){
+		++m_runs.back().m_numTicks;
+	}
+	else{
+		InputRun run;
+		run.m_input = input;
+		run.m_numTicks = 1;
+		m_runs.push_back(run);
+	}
+
+	++m_numTicks;
+}
+
+///=====================================================
+/// finalChecksum is the World state after the last recorded tick; a replay must reproduce it exactly
+///=====================================================
+bool InputRecorder::StopRecording(const char* fileName, unsigned int finalChecksum){
+	FATAL_ASSERT(m_state == RECORDER_RECORDING);
+	m_state = RECORDER_IDLE;
+	m_finalChecksum = finalChecksum;
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	WriteValue(file, RECORDING_FILE_ID);
+	WriteValue(file, RECORDING_FILE_VERSION);
+	WriteValue(file, m_seed);
+	WriteValue(file, m_tickSeconds);
+	WriteValue(file, m_numTicks);
+	WriteValue(file, m_finalChecksum);
+	WriteValue(file, (unsigned int)m_runs.size());
+
+	for (std::vector<InputRun>::const_iterator runIter = m_runs.begin(); runIter != m_runs.end(); ++runIter){
+		WriteValue(file, runIter->m_input.m_buttons);
+		WriteValue(file, runIter->m_input.m_joystickX);
+		WriteValue(file, runIter->m_input.m_joystickY);
+		WriteValue(file, runIter->m_numTicks);
+	}
+
+	return file.good();
+}
+
+///=====================================================
+/// Rejects files with an unusable tick length or runs that don't add up to their tick count, including empty runs and more runs than ticks
+///=====================================================
+bool InputRecorder::StartReplay(const char* fileName){
+	Stop();
+
+	std::ifstream file(fileName, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	unsigned int fileID = 0;
+	unsigned int fileVersion = 0;
+	unsigned int numRuns = 0;
+	if (!ReadValue(file, fileID) || fileID != RECORDING_FILE_ID) return false;
+	if (!ReadValue(file, fileVersion) || fileVersion != RECORDING_FILE_VERSION) return false;
+	if (!ReadValue(file, m_seed) || !ReadValue(file, m_tickSeconds) || !ReadValue(file, m_numTicks) || !ReadValue(file, m_finalChecksum) || !ReadValue(file, numRuns))
+		return false;
+
+	//the tick length becomes the replay's simulation step, so it has to be a real, positive time
+	if (!(m_tickSeconds > 0.0) || !std::isfinite(m_tickSeconds)) return false;
+
+	//every run covers at least one tick and is stored in full, so both bound the allocation before reading any runs
+	if (numRuns > m_numTicks) return false;
+
+	const std::streamoff RUN_BYTES = sizeof(unsigned char) + 2 * sizeof(short) + sizeof(unsigned int);
+	std::streamoff numRunBytes = GetRemainingBytes(file);
+	if (numRunBytes < 0 || numRunBytes / RUN_BYTES < (std::streamoff)numRuns) return false;
+
+	m_runs.resize(numRuns);
+	unsigned long long numTicksInRuns = 0;
+	for (std::vector<InputRun>::iterator runIter = m_runs.begin(); runIter != m_runs.end(); ++runIter){
+		if (!ReadValue(file, runIter->m_input.m_buttons) || !ReadValue(file, runIter->m_input.m_joystickX) ||
+			!ReadValue(file, runIter->m_input.m_joystickY) || !ReadValue(file, runIter->m_numTicks) || runIter->m_numTicks == 0){
+			m_runs.clear();
+			return false;
+		}
+		numTicksInRuns += runIter->m_numTicks;
+	}
+	if (numTicksInRuns != m_numTicks){
+		m_runs.clear();
+		return false;
+	}
+
+	m_state = RECORDER_REPLAYING;
+	m_replayRunIndex = 0;
+	m_replayTickInRun = 0;
+	m_numReplayedTicks = 0;
+	return true;
+}
+
+///=====================================================
+/// Returns false once every recorded tick has been played
+///=====================================================
+bool InputRecorder::GetNextReplayTick(TickInput& out_input){
+	FATAL_ASSERT(m_state == RECORDER_REPLAYING);
+	if (IsReplayFinished())
+		return false;
+
+	const InputRun& run = m_runs[m_replayRunIndex];
+	out_input = run.m_input;
+
+	++m_numReplayedTicks;
+	if (++m_replayTickInRun >= run.m_numTicks){
+		++m_replayRunIndex;
+		m_replayTickInRun = 0;
+	}
+	return true;
+}
+
+///=====================================================
+/// Abandons a recording without saving it, or ends a replay early
+///=====================================================
+void InputRecorder::Stop(){
+	m_state = RECORDER_IDLE;
+	m_numReplayedTicks = 0;
+}
@@ -0,0 +1,100 @@
+//=====================================================
+// InputRecorder.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_InputRecorder__
+#define __included_InputRecorder__
+
+#include <vector>
+
+///=====================================================
+/// Everything the player can do to the World during one simulation tick
+/// Joystick axes are quantized so a live tick and its replay apply exactly the same values
+///=====================================================
+struct TickInput{
+	enum TickButton{
+		BUTTON_ROTATE_COUNTERCLOCKWISE = 1 << 0,
+		BUTTON_ROTATE_CLOCKWISE = 1 << 1,
+		BUTTON_THRUST = 1 << 2,
+		BUTTON_FIRE = 1 << 3,
+		BUTTON_CONTROLLER_FIRE = 1 << 4,
+		BUTTON_RESPAWN = 1 << 5,
+		BUTTON_SPAWN_ASTEROID = 1 << 6,
+		BUTTON_DESTROY_ASTEROID = 1 << 7,
+
+		//buttons that stay set until the next sample; the rest are presses that only apply to one tick
+		HELD_BUTTONS = BUTTON_ROTATE_COUNTERCLOCKWISE | BUTTON_ROTATE_CLOCKWISE | BUTTON_THRUST | BUTTON_FIRE | BUTTON_CONTROLLER_FIRE
+	};
+
+	unsigned char m_buttons;
+	short m_joystickX;
+	short m_joystickY;
+
+	TickInput() :
+		m_buttons(0),
+		m_joystickX(0),
+		m_joystickY(0){
+	}
+
+	inline bool IsButtonDown(TickButton button) const{ return (m_buttons & button) != 0; }
+	inline float GetJoystickX() const{ return (float)m_joystickX * (1.0f / 32767.0f); }
+	inline float GetJoystickY() const{ return (float)m_joystickY * (1.0f / 32767.0f); }
+	inline void SetJoystick(float percentX, float percentY){ m_joystickX = (short)(percentX * 32767.0f); m_joystickY = (short)(percentY * 32767.0f); }
+
+	inline bool operator==(const TickInput& other) const{ return m_buttons == other.m_buttons && m_joystickX == other.m_joystickX && m_joystickY == other.m_joystickY; }
+};
+
+///=====================================================
+/// Records the TickInput of every simulation tick and plays them back
+/// Consecutive identical ticks are stored as one run, so a long session with little input stays tiny on disk
+///=====================================================
+class InputRecorder{
+public:
+	enum RecorderState{
+		RECORDER_IDLE,
+		RECORDER_RECORDING,
+		RECORDER_REPLAYING
+	};
+
+private:
+	struct InputRun{
+		TickInput m_input;
+		unsigned int m_numTicks;
+	};
+
+	RecorderState m_state;
+	unsigned int m_seed;
+	double m_tickSeconds;
+	unsigned int m_finalChecksum;
+	std::vector<InputRun> m_runs;
+
+	unsigned int m_numTicks;
+	int m_replayRunIndex;
+	unsigned int m_replayTickInRun;
+	unsigned int m_numReplayedTicks;
+
+public:
+	InputRecorder();
+
+	inline RecorderState GetState() const{ return m_state; }
+	inline bool IsRecording() const{ return m_state == RECORDER_RECORDING; }
+	inline bool IsReplaying() const{ return m_state == RECORDER_REPLAYING; }
+	inline unsigned int GetSeed() const{ return m_seed; }
+	inline double GetTickSeconds() const{ return m_tickSeconds; }
+	inline unsigned int GetNumTicks() const{ return m_numTicks; }
+	inline unsigned int GetFinalChecksum() const{ return m_finalChecksum; }
+	inline bool IsReplayFinished() const{ return m_numReplayedTicks >= m_numTicks; }
+
+	void StartRecording(unsigned int seed, double tickSeconds);
+	void RecordTick(const TickInput& input);
+	bool StopRecording(const char* fileName, unsigned int finalChecksum);
+
+	bool StartReplay(const char* fileName);
+	bool GetNextReplayTick(TickInput& out_input);
+	void Stop();
+};
+
+#endif
\ No newline at end of file
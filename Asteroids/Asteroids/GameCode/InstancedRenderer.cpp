@@ -0,0 +1,185 @@
+//=====================================================
+// InstancedRenderer.cpp
+// by Andrew Socha
+//=====================================================
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include "Engine/Core/EngineCore.hpp"
+#include "InstancedRenderer.hpp"
+#include "ShaderProgramCache.hpp"
+#include "FrameUniformBuffer.hpp"
+#include "GLExtensions.hpp"
+#include "Engine/Console/Console.hpp"
+#include <cstddef>
+
+///=====================================================
+/// 
+///=====================================================
+InstancedRenderer::InstancedRenderer() :
+m_programID(0),
+m_positionLocation(-1),
+m_colorLocation(-1),
+m_instanceTransformLocation(-1),
+m_instanceBufferID(0),
+m_instanceBufferCapacity(0),
+m_baseShape(GL_LINE_LOOP),
+m_batches(){
+}
+
+///=====================================================
+/// 
+///=====================================================
+bool InstancedRenderer::LoadInstancingFunctions(){
+	GLExtensions::Load();
+	return GLExtensions::s_vertexAttribDivisor != nullptr && GLExtensions::s_drawArraysInstanced != nullptr;
+}
+
+///=====================================================
+/// Returns false if instancing isn't supported or the shaders fail to build; callers should fall back to per-object drawing
+///=====================================================
+bool InstancedRenderer::Startup(const char* vertexShaderFile, const char* fragmentShaderFile, GLenum baseShape){
+	FATAL_ASSERT(m_programID == 0);
+	if (!LoadInstancingFunctions())
+		return false;
+
+	//the shaders are shared with per-object drawing; INSTANCED switches them to the per-instance transform and FRAME_UNIFORMS to the shared view and projection
+	m_programID = ShaderProgramCache::BuildProgram(vertexShaderFile, fragmentShaderFile, SHADER_FEATURE_INSTANCED | SHADER_FEATURE_FRAME_UNIFORMS);
+	if (m_programID == 0)
+		return false;
+
+	if (!FrameUniformBuffer::AttachProgram(m_programID)){
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+		return false;
+	}
+
+	m_positionLocation = glGetAttribLocation(m_programID, "inPosition");
+	m_colorLocation = glGetAttribLocation(m_programID, "inColor");
+	m_instanceTransformLocation = glGetAttribLocation(m_programID, "inInstanceTransform");
+	FATAL_ASSERT(m_positionLocation >= 0 && m_instanceTransformLocation >= 0);
+
+	glGenBuffers(1, &m_instanceBufferID);
+	m_baseShape = baseShape;
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void InstancedRenderer::Shutdown(){
+	for (std::vector<InstanceBatch>::iterator batchIter = m_batches.begin(); batchIter != m_batches.end(); ++batchIter){
+		glDeleteBuffers(1, &batchIter->m_vertexBufferID);
+		glDeleteVertexArrays(1, &batchIter->m_vaoID);
+	}
+	m_batches.clear();
+
+	if (m_instanceBufferID != 0){
+		glDeleteBuffers(1, &m_instanceBufferID);
+		m_instanceBufferID = 0;
+		m_instanceBufferCapacity = 0;
+	}
+
+	if (m_programID != 0){
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+}
+
+///=====================================================
+/// Uploads the mesh once as Vertex2D and returns the id to pass to AddInstance
+/// Only the xy of each position is kept; every vertex is drawn white, as the per-object path draws them
+///=====================================================
+int InstancedRenderer::CreateBatch(const std::vector<Vertex_Anim>& vertices){
+	FATAL_ASSERT(IsRunning());
+
+	//only needed until it's uploaded
+	std::vector<Vertex2D> compactVertices;
+	compactVertices.reserve(vertices.size());
+	for (std::vector<Vertex_Anim>::const_iterator vertexIter = vertices.begin(); vertexIter != vertices.end(); ++vertexIter){
+		compactVertices.push_back(Vertex2D(Vec2(vertexIter->m_position.x, vertexIter->m_position.y), 255, 255, 255, 255));
+	}
+
+	InstanceBatch batch;
+	batch.m_numVertices = (int)compactVertices.size();
+
+	glGenVertexArrays(1, &batch.m_vaoID);
+	glBindVertexArray(batch.m_vaoID);
+
+	glGenBuffers(1, &batch.m_vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, batch.m_vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex2D) * compactVertices.size(), compactVertices.empty() ? nullptr : &compactVertices[0], GL_STATIC_DRAW);
+	glEnableVertexAttribArray(m_positionLocation);
+	glVertexAttribPointer(m_positionLocation, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (const GLvoid*)offsetof(Vertex2D, m_position));
+	if (m_colorLocation >= 0){
+		glEnableVertexAttribArray(m_colorLocation);
+		glVertexAttribPointer(m_colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex2D), (const GLvoid*)offsetof(Vertex2D, m_color));
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	glEnableVertexAttribArray(m_instanceTransformLocation);
+	GLExtensions::s_vertexAttribDivisor(m_instanceTransformLocation, 1);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_batches.push_back(batch);
+	return (int)m_batches.size() - 1;
+}
+
+///=====================================================
+/// Keeps each batch's capacity so steady-state frames don't allocate
+///=====================================================
+void InstancedRenderer::ClearInstances(){
+	for (std::vector<InstanceBatch>::iterator batchIter = m_batches.begin(); batchIter != m_batches.end(); ++batchIter){
+		batchIter->m_instances.clear();
+	}
+}
+
+///=====================================================
+/// Streams every batch's instances into the shared instance buffer, then issues one draw per non-empty batch
+///=====================================================
+void InstancedRenderer::Render(){
+	FATAL_ASSERT(IsRunning());
+
+	int numInstances = 0;
+	for (std::vector<InstanceBatch>::const_iterator batchIter = m_batches.begin(); batchIter != m_batches.end(); ++batchIter){
+		numInstances += (int)batchIter->m_instances.size();
+	}
+	if (numInstances == 0)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	while (m_instanceBufferCapacity < numInstances){
+		m_instanceBufferCapacity = (m_instanceBufferCapacity == 0) ? 1024 : m_instanceBufferCapacity * 2;
+	}
+	//orphan last frame's storage so the driver doesn't stall waiting for it
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceTransform) * m_instanceBufferCapacity, nullptr, GL_STREAM_DRAW);
+
+	int instanceOffset = 0;
+	for (std::vector<InstanceBatch>::const_iterator batchIter = m_batches.begin(); batchIter != m_batches.end(); ++batchIter){
+		int batchSize = (int)batchIter->m_instances.size();
+		if (batchSize == 0) continue;
+
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(InstanceTransform) * instanceOffset, sizeof(InstanceTransform) * batchSize, &batchIter->m_instances[0]);
+		instanceOffset += batchSize;
+	}
+
+	glUseProgram(m_programID);
+
+	instanceOffset = 0;
+	for (std::vector<InstanceBatch>::const_iterator batchIter = m_batches.begin(); batchIter != m_batches.end(); ++batchIter){
+		int batchSize = (int)batchIter->m_instances.size();
+		if (batchSize == 0) continue;
+
+		glBindVertexArray(batchIter->m_vaoID);
+		glVertexAttribPointer(m_instanceTransformLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceTransform), (const GLvoid*)(sizeof(InstanceTransform) * instanceOffset));
+		GLExtensions::s_drawArraysInstanced(m_baseShape, 0, batchIter->m_numVertices, batchSize);
+
+		instanceOffset += batchSize;
+	}
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glUseProgram(0);
+}
@@ -0,0 +1,89 @@
+//=====================================================
+// InstancedRenderer.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_InstancedRenderer__
+#define __included_InstancedRenderer__
+
+#include <vector>
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Renderer/OpenGLRenderer.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+
+///=====================================================
+/// Compact vertex for flat outlines, read by the INSTANCED variant of basic2DLine.vert as a vec2 position and a normalized RGBA8 color
+/// 12 bytes, where Vertex_Anim also carries UVs, a tangent frame and bone weights that line drawing never reads
+///=====================================================
+struct Vertex2D{
+	Vec2 m_position;
+	unsigned char m_color[4];
+
+	Vertex2D(const Vec2& position, unsigned char r, unsigned char g, unsigned char b, unsigned char a) :
+		m_position(position){
+		m_color[0] = r;
+		m_color[1] = g;
+		m_color[2] = b;
+		m_color[3] = a;
+	}
+};
+
+///=====================================================
+/// Per-instance data read by the INSTANCED variant of basic2DLine.vert as a single vec4
+///=====================================================
+struct InstanceTransform{
+	Vec2 m_position;
+	float m_orientationDegrees;
+	float m_scale;
+
+	InstanceTransform(const Vec2& position, float orientationDegrees, float scale) :
+		m_position(position),
+		m_orientationDegrees(orientationDegrees),
+		m_scale(scale){
+	}
+};
+
+///=====================================================
+/// Draws every instance of a mesh with one glDrawArraysInstanced call
+/// Each batch owns a static vertex buffer; the instances of all batches share one streamed instance buffer
+/// The view and projection come from the FrameUniformBuffer, which must be updated for the frame before Render
+///=====================================================
+class InstancedRenderer{
+private:
+	struct InstanceBatch{
+		GLuint m_vaoID;
+		GLuint m_vertexBufferID;
+		int m_numVertices;
+		std::vector<InstanceTransform> m_instances;
+	};
+
+	GLuint m_programID;
+	GLint m_positionLocation;
+	GLint m_colorLocation;
+	GLint m_instanceTransformLocation;
+	GLuint m_instanceBufferID;
+	int m_instanceBufferCapacity;
+	GLenum m_baseShape;
+	std::vector<InstanceBatch> m_batches;
+
+	static bool LoadInstancingFunctions();
+
+public:
+	InstancedRenderer();
+
+	bool Startup(const char* vertexShaderFile, const char* fragmentShaderFile, GLenum baseShape);
+	void Shutdown();
+	inline bool IsRunning() const{ return m_programID != 0; }
+
+	int CreateBatch(const std::vector<Vertex_Anim>& vertices);
+
+	void ClearInstances();
+	inline void AddInstance(int batchID, const InstanceTransform& instance){ m_batches[batchID].m_instances.push_back(instance); }
+	inline int GetNumInstances(int batchID) const{ return (int)m_batches[batchID].m_instances.size(); }
+
+	void Render();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,190 @@
+//=====================================================
+// JobSystem.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "JobSystem.hpp"
+#include "TraceCapture.hpp"
+
+///=====================================================
+/// A negative numWorkerThreads leaves one hardware thread for the caller and uses the rest
+///=====================================================
+JobSystem::JobSystem(int numWorkerThreads) :
+m_workerThreads(),
+m_queues(),
+m_wakeMutex(),
+m_wakeCondition(),
+m_doneCondition(),
+m_numQueuedRanges(0),
+m_numUnfinishedRanges(0),
+m_currentFunction(nullptr),
+m_currentJob(nullptr),
+m_isShuttingDown(false){
+	if (numWorkerThreads < 0){
+		int numHardwareThreads = (int)std::thread::hardware_concurrency();
+		numWorkerThreads = (numHardwareThreads > 1) ? numHardwareThreads - 1 : 0;
+	}
+
+	for (int threadIndex = 0; threadIndex <= numWorkerThreads; ++threadIndex){
+		WorkQueue* queue = new WorkQueue();
+		queue->m_firstRange = 0;
+		m_queues.push_back(queue);
+	}
+
+	m_workerThreads.reserve(numWorkerThreads);
+	for (int threadIndex = 1; threadIndex <= numWorkerThreads; ++threadIndex){
+		m_workerThreads.push_back(std::thread(&JobSystem::WorkerMain, this, threadIndex));
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+JobSystem::~JobSystem(){
+	{
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+		m_isShuttingDown = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::vector<std::thread>::iterator threadIter = m_workerThreads.begin(); threadIter != m_workerThreads.end(); ++threadIter){
+		threadIter->join();
+	}
+
+	for (std::vector<WorkQueue*>::iterator queueIter = m_queues.begin(); queueIter != m_queues.end(); ++queueIter){
+		delete *queueIter;
+	}
+}
+
+///=====================================================
+/// Takes the newest range from this thread's own queue, or else the oldest range from another thread's
+///=====================================================
+bool JobSystem::PopOrStealRange(int threadIndex, JobRange& out_range){
+	WorkQueue* ownQueue = m_queues[threadIndex];
+	{
+		std::lock_guard<std::mutex> queueLock(ownQueue->m_mutex);
+		if (ownQueue->m_firstRange < ownQueue->m_ranges.size()){
+			out_range = ownQueue->m_ranges.back();
+			ownQueue->m_ranges.pop_back();
+			--m_numQueuedRanges;
+			return true;
+		}
+	}
+
+	int numQueues = (int)m_queues.size();
+	for (int offset = 1; offset < numQueues; ++offset){
+		WorkQueue* victimQueue = m_queues[(threadIndex + offset) % numQueues];
+		std::lock_guard<std::mutex> queueLock(victimQueue->m_mutex);
+		if (victimQueue->m_firstRange < victimQueue->m_ranges.size()){
+			out_range = victimQueue->m_ranges[victimQueue->m_firstRange];
+			++victimQueue->m_firstRange;
+			--m_numQueuedRanges;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void JobSystem::FinishRange(){
+	if (--m_numUnfinishedRanges == 0){
+		//notified under the lock, so the calling thread can't see the count hit zero and destroy the condition before this returns
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+		m_doneCondition.notify_one();
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+void JobSystem::WorkerMain(int threadIndex){
+	TraceCapture::NameCurrentThread("Job worker " + std::to_string(threadIndex));
+
+	for (;;){
+		{
+			std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+			m_wakeCondition.wait(wakeLock, [this]{ return m_isShuttingDown || m_numQueuedRanges.load() > 0; });
+			if (m_isShuttingDown)
+				return;
+		}
+
+		JobRange range;
+		while (PopOrStealRange(threadIndex, range)){
+			{
+				//closed before the range counts as finished, so the scope is recorded before the main thread can end the frame
+				TRACE_SCOPE("JobSystem range");
+				m_currentFunction(m_currentJob, range.m_firstItem, range.m_endItem, threadIndex);
+			}
+			FinishRange();
+		}
+	}
+}
+
+///=====================================================
+/// Does the work of ParallelFor once the job has been reduced to a function and a pointer to pass it
+///=====================================================
+void JobSystem::RunRanges(int numItems, int itemsPerRange, RangeFunction function, const void* job){
+	FATAL_ASSERT(itemsPerRange > 0);
+	FATAL_ASSERT(m_numUnfinishedRanges.load() == 0);
+	if (numItems <= 0)
+		return;
+
+	int numRanges = (numItems + itemsPerRange - 1) / itemsPerRange;
+	if (numRanges == 1 || m_workerThreads.empty()){
+		TRACE_SCOPE("JobSystem range");
+		function(job, 0, numItems, 0);
+		return;
+	}
+
+	//published before any range is queued, since a worker still awake from the last loop can grab a range the moment it appears
+	m_currentFunction = function;
+	m_currentJob = job;
+	m_numUnfinishedRanges = numRanges;
+
+	int numQueues = (int)m_queues.size();
+	for (int queueIndex = 0; queueIndex < numQueues; ++queueIndex){
+		//every queue was drained by the last loop; clearing keeps the capacity, so steady state queues without allocating
+		WorkQueue* queue = m_queues[queueIndex];
+		std::lock_guard<std::mutex> queueLock(queue->m_mutex);
+		queue->m_ranges.clear();
+		queue->m_firstRange = 0;
+	}
+	for (int rangeIndex = 0; rangeIndex < numRanges; ++rangeIndex){
+		JobRange range;
+		range.m_firstItem = rangeIndex * itemsPerRange;
+		range.m_endItem = (range.m_firstItem + itemsPerRange < numItems) ? range.m_firstItem + itemsPerRange : numItems;
+
+		WorkQueue* queue = m_queues[rangeIndex % numQueues];
+		std::lock_guard<std::mutex> queueLock(queue->m_mutex);
+		queue->m_ranges.push_back(range);
+	}
+
+	{
+		//added rather than assigned, since an awake worker may already have popped (and counted down) some of the ranges
+		//taking the lock orders this wakeup after any worker that is between checking the counter and going to sleep
+		std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+		m_numQueuedRanges += numRanges;
+	}
+	m_wakeCondition.notify_all();
+
+	JobRange range;
+	while (PopOrStealRange(0, range)){
+		{
+			TRACE_SCOPE("JobSystem range");
+			function(job, range.m_firstItem, range.m_endItem, 0);
+		}
+		FinishRange();
+	}
+
+	{
+		std::unique_lock<std::mutex> wakeLock(m_wakeMutex);
+		m_doneCondition.wait(wakeLock, [this]{ return m_numUnfinishedRanges.load() == 0; });
+	}
+
+	m_currentFunction = nullptr;
+	m_currentJob = nullptr;
+}
@@ -0,0 +1,87 @@
+//=====================================================
+// JobSystem.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_JobSystem__
+#define __included_JobSystem__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///=====================================================
+/// Fixed pool of worker threads that split loops into ranges
+/// Each thread owns a queue of ranges and steals from the others once its own runs dry; the calling thread works too, as thread 0
+/// Threads with nothing left to take sleep rather than spin, and a loop's ranges are queued without allocating once the queues have grown
+///=====================================================
+class JobSystem{
+private:
+	//the job is called through this, so ParallelFor can take any callable without wrapping it in something that allocates
+	typedef void (*RangeFunction)(const void* job, int firstItem, int endItem, int threadIndex);
+
+	struct JobRange{
+		int m_firstItem;
+		int m_endItem;
+	};
+	//ranges are popped from the back by the owner and stolen from m_firstRange on; cleared, keeping capacity, by each loop
+	struct WorkQueue{
+		std::mutex m_mutex;
+		std::vector<JobRange> m_ranges;
+		size_t m_firstRange;
+	};
+
+	std::vector<std::thread> m_workerThreads;
+	std::vector<WorkQueue*> m_queues;
+
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition; //workers wait here for ranges to be queued
+	std::condition_variable m_doneCondition; //the calling thread waits here for the last range to finish
+	std::atomic<int> m_numQueuedRanges; //queued and not yet taken by any thread
+	std::atomic<int> m_numUnfinishedRanges;
+	RangeFunction m_currentFunction;
+	const void* m_currentJob;
+	bool m_isShuttingDown;
+
+	template <typename Job>
+	static void CallJob(const void* job, int firstItem, int endItem, int threadIndex);
+
+	void RunRanges(int numItems, int itemsPerRange, RangeFunction function, const void* job);
+	bool PopOrStealRange(int threadIndex, JobRange& out_range);
+	void FinishRange();
+	void WorkerMain(int threadIndex);
+
+public:
+	explicit JobSystem(int numWorkerThreads = -1);
+	~JobSystem();
+
+	inline int GetNumThreads() const{ return (int)m_queues.size(); }
+
+	//job is called as job(firstItem, endItem, threadIndex)
+	template <typename Job>
+	inline void ParallelFor(int numItems, int itemsPerRange, const Job& job);
+};
+
+
+///=====================================================
+/// 
+///=====================================================
+template <typename Job>
+void JobSystem::CallJob(const void* job, int firstItem, int endItem, int threadIndex){
+	(*static_cast<const Job*>(job))(firstItem, endItem, threadIndex);
+}
+
+///=====================================================
+/// Calls job on consecutive ranges of at most itemsPerRange items covering [0,numItems), and returns once all of them finish
+/// Ranges can run in any order on any thread, so job must only write to data owned by its range or its threadIndex
+///=====================================================
+template <typename Job>
+void JobSystem::ParallelFor(int numItems, int itemsPerRange, const Job& job){
+	RunRanges(numItems, itemsPerRange, &CallJob<Job>, &job);
+}
+
+#endif
\ No newline at end of file
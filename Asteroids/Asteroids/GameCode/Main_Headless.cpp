@@ -0,0 +1,180 @@
+//=====================================================
+// Main_Headless.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "World.hpp"
+#include "JobSystem.hpp"
+#include "TraceCapture.hpp"
+#include "AllocationTracker.hpp"
+#include "FrameArena.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+///=====================================================
+/// 
+///=====================================================
+static void PrintUsage(const char* programName){
+	printf("Usage: %s [--ticks N] [--dt SECONDS] [--seed N] [--threads N] [--no-autofire] [--record FILE | --replay FILE] [--trace FILE [--trace-ticks N]] [--alloc-budget N]\n", programName);
+	printf("  --ticks N       number of fixed simulation ticks to run (default 36000)\n");
+	printf("  --dt SECONDS    seconds simulated per tick (default 1/60)\n");
+	printf("  --seed N        random seed for the world (default 1)\n");
+	printf("  --threads N     worker threads besides the main one; -1 picks one per core (default 0, single-threaded)\n");
+	printf("  --no-autofire   leave the ship idle instead of spinning and firing every tick\n");
+	printf("  --record FILE   save every tick's input so the run can be replayed\n");
+	printf("  --replay FILE   rerun a recording and check it reproduces the same final state\n");
+	printf("  --trace FILE    write a Chrome trace-event JSON of the first ticks, one frame per tick\n");
+	printf("  --trace-ticks N number of ticks to trace (default 600)\n");
+	printf("  --alloc-budget N report every tick with more than N heap allocations\n");
+}
+
+///=====================================================
+/// Runs the Asteroids simulation with no window or GL context and reports how long it took
+///=====================================================
+int main(int argc, char* argv[]){
+	int numTicks = 36000;
+	double deltaSeconds = 1.0 / 60.0;
+	unsigned int seed = 1;
+	int numWorkerThreads = 0;
+	bool isAutofireEnabled = true;
+	const char* recordFileName = nullptr;
+	const char* replayFileName = nullptr;
+	const char* traceFileName = nullptr;
+	int numTraceTicks = 600;
+	unsigned int allocationBudget = 0;
+
+	for (int argIndex = 1; argIndex < argc; ++argIndex){
+		if (strcmp(argv[argIndex], "--ticks") == 0 && argIndex + 1 < argc){
+			numTicks = atoi(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--dt") == 0 && argIndex + 1 < argc){
+			deltaSeconds = atof(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--seed") == 0 && argIndex + 1 < argc){
+			seed = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		}
+		else if (strcmp(argv[argIndex], "--threads") == 0 && argIndex + 1 < argc){
+			numWorkerThreads = atoi(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--no-autofire") == 0){
+			isAutofireEnabled = false;
+		}
+		else if (strcmp(argv[argIndex], "--record") == 0 && argIndex + 1 < argc){
+			recordFileName = argv[++argIndex];
+		}
+		else if (strcmp(argv[argIndex], "--replay") == 0 && argIndex + 1 < argc){
+			replayFileName = argv[++argIndex];
+		}
+		else if (strcmp(argv[argIndex], "--trace") == 0 && argIndex + 1 < argc){
+			traceFileName = argv[++argIndex];
+		}
+		else if (strcmp(argv[argIndex], "--trace-ticks") == 0 && argIndex + 1 < argc){
+			numTraceTicks = atoi(argv[++argIndex]);
+		}
+		else if (strcmp(argv[argIndex], "--alloc-budget") == 0 && argIndex + 1 < argc){
+			allocationBudget = (unsigned int)strtoul(argv[++argIndex], nullptr, 10);
+		}
+		else{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (numTicks <= 0 || deltaSeconds <= 0.0 || numTraceTicks <= 0 || (recordFileName != nullptr && replayFileName != nullptr)){
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	FrameArena frameArena;
+	s_theFrameArena = &frameArena;
+
+	//declared first so it outlives the world
+	std::unique_ptr<JobSystem> jobSystem((numWorkerThreads != 0) ? new JobSystem(numWorkerThreads) : nullptr);
+	World world(Vec2(1600.0f, 900.0f), nullptr, seed, jobSystem.get());
+	if (recordFileName != nullptr){
+		world.StartRecording(seed, deltaSeconds);
+	}
+	else if (replayFileName != nullptr){
+		if (!world.StartReplay(replayFileName)){
+			printf("Failed to load recording %s\n", replayFileName);
+			return 1;
+		}
+		numTicks = (int)world.GetInputRecorder().GetNumTicks();
+		isAutofireEnabled = false;
+	}
+
+	if (traceFileName != nullptr){
+		TraceCapture::NameCurrentThread("Main");
+		TraceCapture::StartCapture((numTraceTicks < numTicks) ? numTraceTicks : numTicks, traceFileName);
+		TraceCapture::FinishFrame(); //starts recording with the first tick
+	}
+
+	//setup allocations count against neither the first tick nor the totals
+	AllocationTracker::FinishFrame();
+	AllocationTracker::ResetFrameStatistics();
+	frameArena.Reset();
+	AllocationTracker::SetFrameBudget(allocationBudget);
+
+	int numShipDeaths = 0;
+	int peakAsteroids = world.GetNumAsteroids();
+	int peakBullets = world.GetNumBullets();
+
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (int tick = 0; tick < numTicks; ++tick){
+		{
+			TRACE_SCOPE("Tick");
+			if (world.IsShipDestroyed()){
+				++numShipDeaths;
+				world.RespawnShip();
+			}
+
+			if (isAutofireEnabled){
+				//a slow sweep with a light touch of thrust keeps the ship moving and sprays bullets in every direction
+				float headingRadians = (float)tick * 0.05f;
+				world.ProcessXBoxController(0.1f * cosf(headingRadians), 0.1f * sinf(headingRadians), 1);
+			}
+
+			world.Update(deltaSeconds);
+
+			if (world.GetNumAsteroids() > peakAsteroids) peakAsteroids = world.GetNumAsteroids();
+			if (world.GetNumBullets() > peakBullets) peakBullets = world.GetNumBullets();
+		}
+		TraceCapture::FinishFrame();
+		AllocationTracker::FinishFrame();
+		frameArena.Reset();
+	}
+	std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+
+	if (recordFileName != nullptr && !world.StopRecording(recordFileName)){
+		printf("Failed to save recording to %s\n", recordFileName);
+		return 1;
+	}
+
+	double wallSeconds = std::chrono::duration<double>(endTime - startTime).count();
+	printf("ticks:            %d\n", numTicks);
+	printf("simulated time:   %.2f s\n", world.GetSimulationSeconds());
+	printf("wall time:        %.3f s\n", wallSeconds);
+	printf("per tick:         %.4f ms\n", 1000.0 * wallSeconds / numTicks);
+	printf("ticks per second: %.0f\n", wallSeconds > 0.0 ? numTicks / wallSeconds : 0.0);
+	printf("stage:            %d\n", world.GetStage());
+	printf("asteroids:        %d (peak %d)\n", world.GetNumAsteroids(), peakAsteroids);
+	printf("bullets:          %d (peak %d)\n", world.GetNumBullets(), peakBullets);
+	printf("ship deaths:      %d\n", numShipDeaths);
+	printf("threads:          %d\n", (jobSystem != nullptr) ? jobSystem->GetNumThreads() : 1);
+	printf("seed:             %u\n", world.GetSeed());
+	printf("state checksum:   0x%08x\n", world.CalcStateChecksum());
+	if (AllocationTracker::IsCompiledIn()){
+		printf("allocations:      %u in the last tick, %u in the worst\n", AllocationTracker::GetLastFrameAllocations(), AllocationTracker::GetWorstFrameAllocations());
+		if (allocationBudget > 0)
+			printf("over budget:      %u of %u ticks\n", AllocationTracker::GetNumFramesOverBudget(), AllocationTracker::GetNumFrames());
+	}
+
+	if (replayFileName != nullptr){
+		printf("replay:           %s\n", world.DidLastReplayMatch() ? "matched" : "DIVERGED");
+		return world.DidLastReplayMatch() ? 0 : 2;
+	}
+	return 0;
+}
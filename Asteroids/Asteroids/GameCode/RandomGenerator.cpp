@@ -0,0 +1,26 @@
+//=====================================================
+// RandomGenerator.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "RandomGenerator.hpp"
+
+///=====================================================
+/// 
+///=====================================================
+RandomGenerator::RandomGenerator(unsigned int seed) :
+m_state(0){
+	Seed(seed);
+}
+
+///=====================================================
+/// Runs the seed through a splitmix64 step so nearby seeds start far apart, and so the state is never zero
+///=====================================================
+void RandomGenerator::Seed(unsigned int seed){
+	unsigned long long mixed = (unsigned long long)seed + 0x9E3779B97F4A7C15ULL;
+	mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+	mixed ^= mixed >> 31;
+
+	m_state = (mixed != 0) ? mixed : 0x9E3779B97F4A7C15ULL;
+}
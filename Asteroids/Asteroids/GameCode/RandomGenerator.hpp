@@ -0,0 +1,63 @@
+//=====================================================
+// RandomGenerator.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_RandomGenerator__
+#define __included_RandomGenerator__
+
+///=====================================================
+/// Small seedable xorshift64* generator
+/// Unlike the engine's global GetRandom* functions, two generators with the same seed produce the same sequence on every platform
+///=====================================================
+class RandomGenerator{
+private:
+	unsigned long long m_state;
+
+	inline unsigned int GetNextUInt();
+
+public:
+	explicit RandomGenerator(unsigned int seed = 0);
+
+	void Seed(unsigned int seed);
+
+	inline int GetIntLessThan(int maxNotInclusive);
+	inline float GetFloatZeroToOne();
+	inline float GetFloatInRange(float minInclusive, float maxInclusive);
+};
+
+
+///=====================================================
+/// 
+///=====================================================
+unsigned int RandomGenerator::GetNextUInt(){
+	m_state ^= m_state >> 12;
+	m_state ^= m_state << 25;
+	m_state ^= m_state >> 27;
+	return (unsigned int)((m_state * 2685821657736338717ULL) >> 32);
+}
+
+///=====================================================
+/// 
+///=====================================================
+int RandomGenerator::GetIntLessThan(int maxNotInclusive){
+	return (int)(GetNextUInt() % (unsigned int)maxNotInclusive);
+}
+
+///=====================================================
+/// 
+///=====================================================
+float RandomGenerator::GetFloatZeroToOne(){
+	return (float)(GetNextUInt() >> 8) * (1.0f / 16777215.0f);
+}
+
+///=====================================================
+/// 
+///=====================================================
+float RandomGenerator::GetFloatInRange(float minInclusive, float maxInclusive){
+	return minInclusive + (maxInclusive - minInclusive) * GetFloatZeroToOne();
+}
+
+#endif
\ No newline at end of file
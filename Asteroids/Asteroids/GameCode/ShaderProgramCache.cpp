@@ -0,0 +1,277 @@
+//=====================================================
+// ShaderProgramCache.cpp
+// by Andrew Socha
+//=====================================================
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include "Engine/Core/EngineCore.hpp"
+#include "ShaderProgramCache.hpp"
+#include "GLExtensions.hpp"
+#include "BinaryFile.hpp"
+#include "Engine/Console/Console.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+
+static const unsigned int PROGRAM_CACHE_FILE_ID = 0x42505341; //"ASPB"
+static const unsigned int PROGRAM_CACHE_FILE_VERSION = 1;
+
+static const char* const SHADER_FEATURE_NAMES[NUM_SHADER_FEATURES] = {
+	"INSTANCED",
+	"FRAME_UNIFORMS"
+};
+
+const char* ShaderProgramCache::CACHE_DIRECTORY = "Data/ShaderCache";
+
+int ShaderProgramCache::s_numCacheHits = 0;
+int ShaderProgramCache::s_numCacheMisses = 0;
+
+///=====================================================
+/// 64-bit FNV-1a, continued from hash
+///=====================================================
+static unsigned long long HashString(unsigned long long hash, const char* text){
+	if (text == nullptr)
+		return hash;
+
+	for (const unsigned char* character = (const unsigned char*)text; *character != '\0'; ++character){
+		hash ^= *character;
+		hash *= 1099511628211ull;
+	}
+	//terminator too, so "ab"+"c" and "a"+"bc" differ
+	hash ^= 0xffu;
+	hash *= 1099511628211ull;
+	return hash;
+}
+
+///=====================================================
+/// Returns false if only uncached building is available
+///=====================================================
+bool ShaderProgramCache::LoadFunctions(){
+	GLExtensions::Load();
+	return GLExtensions::s_programParameteri != nullptr && GLExtensions::s_getProgramBinary != nullptr && GLExtensions::s_programBinary != nullptr;
+}
+
+///=====================================================
+/// Defines every feature in features right after the #version line, then resets the line numbers so compile errors still point at the file
+///=====================================================
+bool ShaderProgramCache::ReadVariantSource(const char* shaderFile, unsigned int features, std::string& out_source){
+	std::ifstream file(shaderFile);
+	if (!file.is_open()){
+		ConsolePrintf("Failed to open shader %s\n", shaderFile);
+		return false;
+	}
+
+	std::stringstream sourceStream;
+	sourceStream << file.rdbuf();
+	std::string source = sourceStream.str();
+
+	//#version has to stay first, so the defines go after it
+	size_t bodyStart = 0;
+	int firstBodyLine = 1;
+	if (source.compare(0, 8, "#version") == 0){
+		size_t versionEnd = source.find('\n');
+		bodyStart = (versionEnd == std::string::npos) ? source.size() : versionEnd + 1;
+		firstBodyLine = 2;
+	}
+
+	out_source.assign(source, 0, bodyStart);
+	if (bodyStart > 0 && out_source[out_source.size() - 1] != '\n')
+		out_source += '\n';
+
+	for (int featureIndex = 0; featureIndex < NUM_SHADER_FEATURES; ++featureIndex){
+		if ((features & (1u << featureIndex)) == 0) continue;
+
+		out_source += "#define ";
+		out_source += SHADER_FEATURE_NAMES[featureIndex];
+		out_source += '\n';
+	}
+
+	char lineDirective[32];
+	snprintf(lineDirective, sizeof(lineDirective), "#line %d\n", firstBodyLine);
+	out_source += lineDirective;
+	out_source.append(source, bodyStart, std::string::npos);
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+GLuint ShaderProgramCache::CompileShader(const char* shaderFile, const std::string& source, GLenum shaderType){
+	const GLchar* sourceText = source.c_str();
+
+	GLuint shaderID = glCreateShader(shaderType);
+	glShaderSource(shaderID, 1, &sourceText, nullptr);
+	glCompileShader(shaderID);
+
+	GLint wasCompiled = GL_FALSE;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &wasCompiled);
+	if (wasCompiled != GL_TRUE){
+		GLchar log[1024];
+		glGetShaderInfoLog(shaderID, sizeof(log), nullptr, log);
+		ConsolePrintf("%s: %s\n", shaderFile, log);
+
+		glDeleteShader(shaderID);
+		return 0;
+	}
+
+	return shaderID;
+}
+
+///=====================================================
+/// Consumes both shaders; returns 0 if linking fails
+///=====================================================
+GLuint ShaderProgramCache::LinkProgram(GLuint vertexShaderID, GLuint fragmentShaderID){
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	if (GLExtensions::s_bindFragDataLocation != nullptr)
+		GLExtensions::s_bindFragDataLocation(programID, 0, "outColor");
+	if (GLExtensions::s_programParameteri != nullptr)
+		GLExtensions::s_programParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(programID);
+
+	glDetachShader(programID, vertexShaderID);
+	glDetachShader(programID, fragmentShaderID);
+	glDeleteShader(vertexShaderID);
+	glDeleteShader(fragmentShaderID);
+
+	GLint wasLinked = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &wasLinked);
+	if (wasLinked != GL_TRUE){
+		GLchar log[1024];
+		glGetProgramInfoLog(programID, sizeof(log), nullptr, log);
+		ConsolePrintf("Program failed to link: %s\n", log);
+
+		glDeleteProgram(programID);
+		return 0;
+	}
+
+	return programID;
+}
+
+///=====================================================
+/// 
+///=====================================================
+std::string ShaderProgramCache::GetCacheFileName(const std::string& vertexSource, const std::string& fragmentSource){
+	unsigned long long hash = 14695981039346656037ull;
+	hash = HashString(hash, vertexSource.c_str());
+	hash = HashString(hash, fragmentSource.c_str());
+	hash = HashString(hash, (const char*)glGetString(GL_VENDOR));
+	hash = HashString(hash, (const char*)glGetString(GL_RENDERER));
+	hash = HashString(hash, (const char*)glGetString(GL_VERSION));
+
+	char fileName[64];
+	snprintf(fileName, sizeof(fileName), "/%016llx.bin", hash);
+	return std::string(CACHE_DIRECTORY) + fileName;
+}
+
+///=====================================================
+/// Returns 0 on a miss, including a damaged file or a binary the driver no longer accepts
+///=====================================================
+GLuint ShaderProgramCache::LoadCachedProgram(const std::string& cacheFileName){
+	std::ifstream file(cacheFileName.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return 0;
+
+	unsigned int fileID = 0;
+	unsigned int fileVersion = 0;
+	GLenum binaryFormat = 0;
+	GLint binaryLength = 0;
+	if (!ReadValue(file, fileID) || fileID != PROGRAM_CACHE_FILE_ID) return 0;
+	if (!ReadValue(file, fileVersion) || fileVersion != PROGRAM_CACHE_FILE_VERSION) return 0;
+	if (!ReadValue(file, binaryFormat) || !ReadValue(file, binaryLength) || binaryLength <= 0) return 0;
+	//the binary is the rest of the file, so a truncated or corrupt length is a miss rather than a huge allocation
+	if (GetRemainingBytes(file) != (std::streamoff)binaryLength) return 0;
+
+	std::vector<char> binary(binaryLength);
+	file.read(&binary[0], binaryLength);
+	if (!file.good())
+		return 0;
+
+	GLuint programID = glCreateProgram();
+	GLExtensions::s_programBinary(programID, binaryFormat, &binary[0], binaryLength);
+
+	GLint wasLinked = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &wasLinked);
+	if (wasLinked != GL_TRUE){
+		glDeleteProgram(programID);
+		return 0;
+	}
+
+	return programID;
+}
+
+///=====================================================
+/// A failed save only costs the next startup a compile, so it isn't reported
+///=====================================================
+void ShaderProgramCache::SaveCachedProgram(GLuint programID, const std::string& cacheFileName){
+	GLint binaryLength = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+		return;
+
+	std::vector<char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	GLsizei writtenLength = 0;
+	GLExtensions::s_getProgramBinary(programID, binaryLength, &writtenLength, &binaryFormat, &binary[0]);
+	if (writtenLength <= 0)
+		return;
+
+	CreateDirectoryA(CACHE_DIRECTORY, nullptr);
+	std::ofstream file(cacheFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return;
+
+	WriteValue(file, PROGRAM_CACHE_FILE_ID);
+	WriteValue(file, PROGRAM_CACHE_FILE_VERSION);
+	WriteValue(file, binaryFormat);
+	WriteValue(file, (GLint)writtenLength);
+	file.write(&binary[0], writtenLength);
+}
+
+///=====================================================
+/// Returns 0 if either shader is missing or the program fails to build
+/// The fragment shader's outColor is bound to output 0 before linking
+///=====================================================
+GLuint ShaderProgramCache::BuildProgram(const char* vertexShaderFile, const char* fragmentShaderFile, unsigned int features){
+	FATAL_ASSERT(features < (1u << NUM_SHADER_FEATURES));
+	bool canCache = LoadFunctions();
+
+	std::string vertexSource;
+	std::string fragmentSource;
+	if (!ReadVariantSource(vertexShaderFile, features, vertexSource) || !ReadVariantSource(fragmentShaderFile, features, fragmentSource))
+		return 0;
+
+	std::string cacheFileName;
+	if (canCache){
+		cacheFileName = GetCacheFileName(vertexSource, fragmentSource);
+		GLuint cachedProgramID = LoadCachedProgram(cacheFileName);
+		if (cachedProgramID != 0){
+			++s_numCacheHits;
+			return cachedProgramID;
+		}
+		++s_numCacheMisses;
+	}
+
+	GLuint vertexShaderID = CompileShader(vertexShaderFile, vertexSource, GL_VERTEX_SHADER);
+	GLuint fragmentShaderID = CompileShader(fragmentShaderFile, fragmentSource, GL_FRAGMENT_SHADER);
+	if (vertexShaderID == 0 || fragmentShaderID == 0){
+		if (vertexShaderID != 0) glDeleteShader(vertexShaderID);
+		if (fragmentShaderID != 0) glDeleteShader(fragmentShaderID);
+		return 0;
+	}
+
+	GLuint programID = LinkProgram(vertexShaderID, fragmentShaderID);
+	if (programID != 0 && canCache)
+		SaveCachedProgram(programID, cacheFileName);
+	return programID;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+//=====================================================
+// ShaderProgramCache.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_ShaderProgramCache__
+#define __included_ShaderProgramCache__
+
+#include <string>
+#include "Engine/Renderer/OpenGLRenderer.hpp"
+
+///=====================================================
+/// Feature flags a shader source can test with #ifdef; each set bit is defined under its name before compiling
+///=====================================================
+enum ShaderFeature{
+	SHADER_FEATURE_INSTANCED = 1 << 0,
+	SHADER_FEATURE_FRAME_UNIFORMS = 1 << 1,
+	NUM_SHADER_FEATURES = 2
+};
+
+///=====================================================
+/// Builds GL programs from shader files, one variant per set of ShaderFeature flags, and keeps their linked binaries on disk
+/// A cached binary is keyed by a hash of the final sources and the driver's vendor, renderer and version strings, so any edit or driver update just misses
+/// Without program binary support every build compiles from source
+///=====================================================
+class ShaderProgramCache{
+public:
+	static const char* CACHE_DIRECTORY;
+
+	static GLuint BuildProgram(const char* vertexShaderFile, const char* fragmentShaderFile, unsigned int features);
+
+	static inline int GetNumCacheHits(){ return s_numCacheHits; }
+	static inline int GetNumCacheMisses(){ return s_numCacheMisses; }
+
+private:
+	static int s_numCacheHits;
+	static int s_numCacheMisses;
+
+	static bool LoadFunctions();
+	static bool ReadVariantSource(const char* shaderFile, unsigned int features, std::string& out_source);
+	static GLuint CompileShader(const char* shaderFile, const std::string& source, GLenum shaderType);
+	static GLuint LinkProgram(GLuint vertexShaderID, GLuint fragmentShaderID);
+	static std::string GetCacheFileName(const std::string& vertexSource, const std::string& fragmentSource);
+	static GLuint LoadCachedProgram(const std::string& cacheFileName);
+	static void SaveCachedProgram(GLuint programID, const std::string& cacheFileName);
+};
+
+#endif
\ No newline at end of file
@@ -8,14 +8,29 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/Assert.hpp"
 
+//nose of the hull in ship space; kept here so bullets can spawn without a mesh
+const Vec2 Ship::SHIP_FRONT_POSITION(20.0f, 0.0f);
+//middle of the back of the hull, where the thruster attaches
+const Vec2 Ship::THRUSTER_BASE_POSITION(-20.0f, 0.0f);
+
 ///=====================================================
 /// 
 ///=====================================================
-Ship::Ship(const Vec2& position, const OpenGLRenderer& renderer, EngineAndrew::Material& material) :
+Ship::Ship(const Vec2& position, const OpenGLRenderer* renderer, EngineAndrew::Material* material) :
 GameEntity(position, renderer, material),
 m_thrustFraction(0.0f),
 m_didThrustThisFrame(false),
 m_isDestroyed(false){
+	m_radius = 10.0f;
+
+	m_physics.m_orientationDegrees = 90.0f;
+
+#ifndef ASTEROIDS_HEADLESS
+	m_thrusterObjectToWorld = nullptr;
+	m_thrusterWorldToCamera = nullptr;
+	m_thrusterStretchUniform = nullptr;
+	m_thrusterStretch = 1.0f;
+
 	//ship
 	Vertex_Anim shipV1(Vec3(-20.0f, 10.0f, 0.0f));
 	Vertex_Anim shipV2(Vec3(20.0f, 0.0f, 0.0f));
@@ -25,47 +40,99 @@ m_isDestroyed(false){
 	m_mesh.m_vertices.push_back(shipV2);
 	m_mesh.m_vertices.push_back(shipV3);
 
-	//thruster
-	Vertex_Anim thrusterV1(Vec3(-20.0f, -5.0f, 0.0f));
-	Vertex_Anim thrusterV2(Vec3(-30.0f, 0.0f, 0.0f));
-	Vertex_Anim thrusterV3(Vec3(-20.0f, 5.0f, 0.0f));
-	m_mesh.m_vertices.push_back(thrusterV1);
-	m_mesh.m_vertices.push_back(thrusterV2);
-	m_mesh.m_vertices.push_back(thrusterV3);
-	m_mesh.m_vertices.push_back(thrusterV1);
+	if (renderer != nullptr && material != nullptr){
+		m_mesh.UseDefaultIndeces();
+		m_mesh.SendVertexDataToBuffer(renderer);
 
-	m_radius = 10.0f;
-
-	m_physics.m_orientationDegrees = 90.0f;
+		StartupThruster(renderer);
+	}
+#endif
+}
 
-	m_mesh.UseDefaultIndeces();
-	m_mesh.SendVertexDataToBuffer(&renderer, true);
+#ifndef ASTEROIDS_HEADLESS
+///=====================================================
+/// The thruster is its own static mesh, relative to THRUSTER_BASE_POSITION, drawn with a material whose shader stretches it along the ship's axis
+///=====================================================
+void Ship::StartupThruster(const OpenGLRenderer* renderer){
+	m_thrusterMaterial.CreateProgram(renderer, "Data/Shaders/shipThruster.vert", "Data/Shaders/basic2DLine.frag");
+	m_thrusterMaterial.CreateSampler(renderer);
+	m_thrusterMaterial.SetBaseShape(GL_LINE_LOOP);
+
+	UniformMatrix* projection = (UniformMatrix*)m_thrusterMaterial.CreateUniform("u_cameraToClip");
+	FATAL_ASSERT(projection != nullptr);
+	projection->m_data.push_back(renderer->CreateOrthographicMatrix());
+
+	m_thrusterObjectToWorld = (UniformMatrix*)m_thrusterMaterial.CreateUniform("u_objectToWorld");
+	FATAL_ASSERT(m_thrusterObjectToWorld != nullptr);
+	m_thrusterObjectToWorld->m_data.push_back(Matrix4());
+
+	m_thrusterWorldToCamera = (UniformMatrix*)m_thrusterMaterial.CreateUniform("u_worldToCamera");
+	FATAL_ASSERT(m_thrusterWorldToCamera != nullptr);
+	m_thrusterWorldToCamera->m_data.push_back(Matrix4());
+
+	m_thrusterStretchUniform = (UniformMatrix*)m_thrusterMaterial.CreateUniform("u_thrusterStretch");
+	FATAL_ASSERT(m_thrusterStretchUniform != nullptr);
+	m_thrusterStretchUniform->m_data.push_back(Matrix4::CreateScale(1.0f));
+
+	m_thrusterMesh.Startup(renderer);
+	m_thrusterMaterial.BindVertexData(m_thrusterMesh);
+
+	Vertex_Anim thrusterV1(Vec3(0.0f, -5.0f, 0.0f));
+	Vertex_Anim thrusterV2(Vec3(-10.0f, 0.0f, 0.0f));
+	Vertex_Anim thrusterV3(Vec3(0.0f, 5.0f, 0.0f));
+	m_thrusterMesh.m_vertices.push_back(thrusterV1);
+	m_thrusterMesh.m_vertices.push_back(thrusterV2);
+	m_thrusterMesh.m_vertices.push_back(thrusterV3);
+
+	m_thrusterMesh.UseDefaultIndeces();
+	m_thrusterMesh.SendVertexDataToBuffer(renderer);
 }
+#endif
 
 ///=====================================================
 /// 
 ///=====================================================
-void Ship::Update(double deltaSeconds, const OpenGLRenderer& renderer){
-	static Vec3 thrusterEnd = m_mesh.m_vertices[THRUSTER_END_VERTEX_INDEX].m_position;
-
+void Ship::Update(double deltaSeconds, const OpenGLRenderer* renderer){
 	if (m_didThrustThisFrame){
 		ApplyThrust(deltaSeconds);
 		
-		m_mesh.m_vertices[THRUSTER_END_VERTEX_INDEX].m_position = thrusterEnd * (0.5f + 0.5f*m_thrustFraction) * GetRandomFloatInRange(0.9f, 1.1f);
+#ifndef ASTEROIDS_HEADLESS
+		//the tip used to sit at (-30,0) scaled by this about the ship's origin; as a stretch of the 10 unit thruster from its base that's 3*scale - 2
+		float tipScale = (0.5f + 0.5f*m_thrustFraction) * GetRandomFloatInRange(0.9f, 1.1f);
+		m_thrusterStretch = 3.0f * tipScale - 2.0f;
+#endif
 
 		m_didThrustThisFrame = false;
 		m_thrustFraction = 0.0f;
 	}
+#ifndef ASTEROIDS_HEADLESS
 	else {
-		m_mesh.m_vertices[THRUSTER_END_VERTEX_INDEX] = thrusterEnd;
+		m_thrusterStretch = 1.0f;
 	}
-
-
-	m_mesh.SendVertexDataToBuffer(&renderer, true);
+#endif
 
 	GameEntity::Update(deltaSeconds, renderer);
 }
 
+#ifndef ASTEROIDS_HEADLESS
+///=====================================================
+/// 
+///=====================================================
+void Ship::Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld, float interpolationFraction) const{
+	GameEntity::Draw(material, objectToWorld, interpolationFraction);
+	if (m_thrusterObjectToWorld == nullptr) return;
+
+	Matrix4 modelMatrix;
+	modelMatrix.Translate(THRUSTER_BASE_POSITION);
+	modelMatrix.RotateDegreesAboutZ(m_physics.m_orientationDegrees);
+	modelMatrix.Translate(GetInterpolatedPosition(interpolationFraction));
+	m_thrusterObjectToWorld->m_data[0] = modelMatrix;
+	m_thrusterStretchUniform->m_data[0] = Matrix4::CreateScale(m_thrusterStretch);
+
+	m_thrusterMaterial.Render(m_thrusterMesh);
+}
+#endif
+
 ///=====================================================
 /// 
 ///=====================================================
@@ -82,11 +149,11 @@ void Ship::ApplyThrust(double deltaSeconds){
 ///=====================================================
 /// 
 ///=====================================================
-Bullet* Ship::SpawnBullet(const OpenGLRenderer& renderer, EngineAndrew::Material& material){
-	Vec2 bulletLocation = Vec2(m_mesh.m_vertices[SHIP_FRONT_VERTEX_INDEX].m_position);
+Vec2 Ship::GetBulletSpawnPosition() const{
+	Vec2 bulletLocation = SHIP_FRONT_POSITION;
 	bulletLocation.RotateDegrees(m_physics.m_orientationDegrees);
 	bulletLocation += m_physics.m_position;
 
-	return new Bullet(bulletLocation, m_physics.m_orientationDegrees, renderer, material);
+	return bulletLocation;
 }
 
@@ -9,8 +9,10 @@
 #define __included_Ship__
 
 #include "GameEntity.hpp"
+#ifndef ASTEROIDS_HEADLESS
+#include "Engine/Renderer/Material.hpp"
+#endif
 class OpenGLRenderer;
-#include "Bullet.hpp"
 
 class Ship : public GameEntity{
 private:
@@ -18,27 +20,46 @@ private:
 	bool m_didThrustThisFrame;
 	bool m_isDestroyed;
 
-	const unsigned int THRUSTER_END_VERTEX_INDEX = 4;
-	const unsigned int SHIP_FRONT_VERTEX_INDEX = 1;
+#ifndef ASTEROIDS_HEADLESS
+	//the thruster's vertices never change; its flicker is a stretch uniform, so nothing is re-uploaded per frame
+	EngineAndrew::Mesh m_thrusterMesh;
+	EngineAndrew::Material m_thrusterMaterial;
+	UniformMatrix* m_thrusterObjectToWorld;
+	UniformMatrix* m_thrusterWorldToCamera;
+	UniformMatrix* m_thrusterStretchUniform;
+	float m_thrusterStretch;
+
+	void StartupThruster(const OpenGLRenderer* renderer);
+#endif
+
 	const float SHIP_ACCELERATION = 300.0f;
 
+	static const Vec2 SHIP_FRONT_POSITION;
+	static const Vec2 THRUSTER_BASE_POSITION;
+
 public:
-	Ship(const Vec2& position, const OpenGLRenderer& renderer, EngineAndrew::Material& material);
+	Ship(const Vec2& position, const OpenGLRenderer* renderer, EngineAndrew::Material* material);
 
 	inline bool IsDestroyed() const{return m_isDestroyed;}
 
 	inline void Destroy() { m_isDestroyed = true; }
 	inline void Respawn(const Vec2& initialPosition);
 
-	Bullet* SpawnBullet(const OpenGLRenderer& renderer, EngineAndrew::Material& material);
+	Vec2 GetBulletSpawnPosition() const;
+	inline float GetOrientationDegrees() const{return m_physics.m_orientationDegrees;}
 
 	inline void RotateCounterClockwise();
 	inline void RotateClockwise();
 	inline void SetThrust(float thrustFraction);
 	inline void SetOrientationDegrees(float orientationDegrees){m_physics.m_orientationDegrees = orientationDegrees;}
 
-	void Update(double deltaSeconds, const OpenGLRenderer& renderer);
+	void Update(double deltaSeconds, const OpenGLRenderer* renderer);
 	void ApplyThrust(double deltaSeconds);
+#ifndef ASTEROIDS_HEADLESS
+	void Draw(const EngineAndrew::Material& material, UniformMatrix* objectToWorld, float interpolationFraction) const;
+	//the hull uses the caller's material, but the thruster has its own and needs the camera passed on
+	inline void SetWorldToCamera(const Matrix4& worldToCamera){ if (m_thrusterWorldToCamera != nullptr) m_thrusterWorldToCamera->m_data[0] = worldToCamera; }
+#endif
 };
 
 
@@ -69,7 +90,10 @@ void Ship::SetThrust(float thrustFraction){
 ///=====================================================
 void Ship::Respawn(const Vec2& initialPosition){
 	m_isDestroyed = false;
+	m_thrustFraction = 0.0f;
+	m_didThrustThisFrame = false;
 	m_physics.m_position = initialPosition;
+	m_previousPosition = initialPosition;
 	m_physics.m_velocity = Vec2(0.0f, 0.0f);
 	m_physics.m_orientationDegrees = 90.0f;
 }
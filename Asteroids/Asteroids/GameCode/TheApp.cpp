@@ -14,9 +14,16 @@
 #include "Engine/Console/ConsoleCommands.hpp"
 #include "Engine/Renderer/OpenGLRenderer.hpp"
 #include "World.hpp"
+#include "JobSystem.hpp"
+#include "TraceCapture.hpp"
+#include "AllocationTracker.hpp"
+#include "FrameArena.hpp"
 #include "Engine/Core/SignpostMemoryManager.hpp"
 #include <Xinput.h>
+#include <ctime>
+#include <cstdlib>
 
+static const float WORLD_SIZE_IN_SCREENS = 4.0f;
 
 ///=====================================================
 /// 
@@ -24,6 +31,8 @@
 TheApp::TheApp(){
 	m_isRunning = true;
 	m_world = 0;
+	m_jobSystem = 0;
+	m_tickAccumulatorSeconds = 0.0;
 }
 
 ///=====================================================
@@ -40,6 +49,10 @@ void TheApp::Startup(void* windowHandle){
 	m_windowHandle = windowHandle;
 
 	InitializeTimer();
+	TraceCapture::NameCurrentThread("Main");
+
+	//grows to the busiest frame's needs after the first few frames
+	s_theFrameArena = new FrameArena();
 
 	m_masterClock = new Clock(nullptr);
 	RECOVERABLE_ASSERT(m_masterClock != nullptr);
@@ -73,8 +86,12 @@ void TheApp::Startup(void* windowHandle){
 
 		ProfileSection::StartupProfiling(m_renderer);
 
-		Vec2 displaySize(m_renderer->GetDisplayWidth(), m_renderer->GetDisplayHeight());
-		m_world = new World(displaySize, m_renderer);
+		m_jobSystem = new JobSystem();
+		RECOVERABLE_ASSERT(m_jobSystem != nullptr);
+
+		//the camera follows the ship around a world several screens across
+		Vec2 worldSize(WORLD_SIZE_IN_SCREENS * m_renderer->GetDisplayWidth(), WORLD_SIZE_IN_SCREENS * m_renderer->GetDisplayHeight());
+		m_world = new World(worldSize, m_renderer, (unsigned int)time(nullptr), m_jobSystem);
 		RECOVERABLE_ASSERT(m_world != nullptr);
 		if (m_world == nullptr) {
 			m_isRunning = false;
@@ -90,9 +107,13 @@ void TheApp::Startup(void* windowHandle){
 ///=====================================================
 void TheApp::Run(){
 	while(m_isRunning){
-		ProcessInput();
-		UpdateWorld();
-		RenderWorld();
+		{
+			TRACE_SCOPE("Frame");
+			ProcessInput();
+			UpdateWorld();
+			RenderWorld();
+		}
+		TraceCapture::FinishFrame();
 	}
 }
 
@@ -107,6 +128,9 @@ void TheApp::Shutdown(){
 		delete m_world;
 	}
 
+	if (m_jobSystem)
+		delete m_jobSystem;
+
 	if (m_console) {
 		m_console->Shutdown(m_renderer);
 		delete m_console;
@@ -131,12 +155,17 @@ void TheApp::Shutdown(){
 
 	if (s_theCommandList)
 		delete s_theCommandList;
+
+	delete s_theFrameArena;
+	s_theFrameArena = nullptr;
 }
 
 ///=====================================================
 /// 
 ///=====================================================
 void TheApp::ProcessInput(){
+	TRACE_SCOPE("TheApp::ProcessInput");
+	ALLOCATION_SCOPE("TheApp::ProcessInput");
 	if (m_inputSystem) {
 		m_inputSystem->Update();
 
@@ -223,18 +252,22 @@ void TheApp::ProcessInput(){
 		}
 		else if(errorStatus == ERROR_DEVICE_NOT_CONNECTED){
 			//ConsolePrintf( "Xbox controller is not connected.\n" );
+			m_world->ProcessXBoxController(0.0f, 0.0f, 0);
 		}
 		else{
 			ConsolePrintf( "Xbox controller reports unknown error status code %u (0x%08x).\n", errorStatus, errorStatus );
+			m_world->ProcessXBoxController(0.0f, 0.0f, 0);
 		}
 	}
 
 }
 
 ///=====================================================
-/// 
+/// The world always steps in fixed SIMULATION_TICK_SECONDS ticks; leftover time carries over to the next frame
 ///=====================================================
 void TheApp::UpdateWorld(){
+	TRACE_SCOPE("TheApp::UpdateWorld");
+	ALLOCATION_SCOPE("TheApp::UpdateWorld");
 	double currentTime = GetCurrentSeconds();
 	static double lastTime = currentTime;
 	float deltaSeconds = (float)(currentTime - lastTime);
@@ -251,7 +284,14 @@ void TheApp::UpdateWorld(){
 	}
 
 	if (m_world) {
-		m_world->Update(deltaSeconds);
+		m_tickAccumulatorSeconds += deltaSeconds;
+		while (m_tickAccumulatorSeconds >= World::SIMULATION_TICK_SECONDS){
+			m_world->Update(World::SIMULATION_TICK_SECONDS);
+			m_tickAccumulatorSeconds -= World::SIMULATION_TICK_SECONDS;
+			//once per tick rather than per frame, so a catch-up frame's ticks don't all hold their memory at once
+			if (s_theFrameArena)
+				s_theFrameArena->Reset();
+		}
 
 		if (!m_world->IsRunning())
 			m_isRunning = false;
@@ -262,10 +302,12 @@ void TheApp::UpdateWorld(){
 /// 
 ///=====================================================
 void TheApp::RenderWorld() const{
+	TRACE_SCOPE("TheApp::RenderWorld");
+	ALLOCATION_SCOPE("TheApp::RenderWorld");
 	m_renderer->ClearBuffer();
 
 	if (m_world)
-		m_world->Draw();
+		m_world->Draw((float)(m_tickAccumulatorSeconds / World::SIMULATION_TICK_SECONDS));
 
 	m_console->RenderText(m_renderer, "Data/Fonts/Arial", 32.0f, Vec2(10.0f, 10.0f));
 
@@ -276,4 +318,61 @@ void TheApp::RenderWorld() const{
 
 	if (s_theMemoryManager)
 		s_theMemoryManager->FinishFrame();
+	AllocationTracker::FinishFrame();
+}
+
+
+///=====================================================
+/// TRACE [frames] [file]: writes every traced scope of the next frames (default 300) to file (default trace.json)
+///=====================================================
+CONSOLE_COMMAND(TRACE){
+	int numFrames = 300;
+	std::string fileName = "trace.json";
+	if (args->m_args != nullptr){
+		int numArgs = atoi(args->m_args[0].c_str());
+		if (numArgs < 1 || numArgs > 2)
+			return false;
+
+		numFrames = atoi(args->m_args[1].c_str());
+		if (numArgs == 2)
+			fileName = args->m_args[2];
+	}
+	if (numFrames <= 0)
+		return false;
+
+	TraceCapture::StartCapture(numFrames, fileName.c_str());
+	ConsolePrintf("Tracing the next %d frames to %s\n", numFrames, fileName.c_str());
+	return true;
+}
+
+//only registered where the tracker is compiled in; the Windows configurations leave global operator new to the engine's memory manager
+#ifdef ASTEROIDS_TRACK_ALLOCATIONS
+///=====================================================
+/// 
+///=====================================================
+CONSOLE_COMMAND(MEMORY_FRAME){
+	if (args->m_args != nullptr) return false;
+
+	AllocationTracker::PrintLastFrame();
+	return true;
+}
+
+///=====================================================
+/// MEMORY_BUDGET [allocations]: reports every frame with more heap allocations than this; 0 or no argument turns it off
+///=====================================================
+CONSOLE_COMMAND(MEMORY_BUDGET){
+	unsigned int maxAllocationsPerFrame = 0;
+	if (args->m_args != nullptr){
+		if (args->m_args[0] != "1")
+			return false;
+		maxAllocationsPerFrame = (unsigned int)strtoul(args->m_args[1].c_str(), nullptr, 10);
+	}
+
+	AllocationTracker::SetFrameBudget(maxAllocationsPerFrame);
+	if (maxAllocationsPerFrame > 0)
+		ConsolePrintf("Reporting frames with more than %u allocations\n", maxAllocationsPerFrame);
+	else
+		ConsolePrintf("Allocation budget off\n");
+	return true;
 }
+#endif
\ No newline at end of file
@@ -14,6 +14,7 @@ class InputSystem;
 class SoundSystem;
 class Clock;
 class Console;
+class JobSystem;
 
 class TheApp{
 public:
@@ -38,6 +39,8 @@ private:
 	World* m_world;
 	Console* m_console;
 	Clock* m_masterClock;
+	JobSystem* m_jobSystem;
+	double m_tickAccumulatorSeconds;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,206 @@
+//=====================================================
+// TraceCapture.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "TraceCapture.hpp"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const int TraceCapture::MAX_EVENTS_PER_THREAD = 1 << 16;
+
+std::atomic<bool> TraceCapture::s_isCapturing(false);
+int TraceCapture::s_numFramesToCapture = 0;
+int TraceCapture::s_numFramesCaptured = 0;
+std::string TraceCapture::s_fileName;
+TraceCapture::Clock::time_point TraceCapture::s_captureStartTime;
+
+namespace{
+	struct TraceEvent{
+		const char* m_name;
+		TraceCapture::Clock::time_point m_startTime;
+		TraceCapture::Clock::time_point m_endTime;
+	};
+
+	///=====================================================
+	/// Only its own thread writes events; m_numEvents is published with release so the main thread can read them once the frame is done
+	/// Sized in full when the thread registers, so recording never allocates
+	///=====================================================
+	struct ThreadTraceBuffer{
+		int m_threadID;
+		std::string m_threadName;
+		std::vector<TraceEvent> m_events;
+		std::atomic<int> m_numEvents;
+		std::atomic<int> m_numDroppedEvents;
+
+		explicit ThreadTraceBuffer(int threadID) :
+			m_threadID(threadID),
+			m_threadName(),
+			m_events(TraceCapture::MAX_EVENTS_PER_THREAD),
+			m_numEvents(0),
+			m_numDroppedEvents(0){
+		}
+	};
+
+	//buffers live until exit, since a thread_local pointer to one can outlast any capture
+	std::mutex s_registryMutex;
+	std::vector<std::unique_ptr<ThreadTraceBuffer> > s_threadBuffers;
+	thread_local ThreadTraceBuffer* s_currentThreadBuffer = nullptr;
+	std::atomic<int> s_numUnregisteredEvents(0);
+
+	///=====================================================
+	/// The console isn't linked into the headless build
+	///=====================================================
+	void PrintTraceMessage(const char* message){
+#ifndef ASTEROIDS_HEADLESS
+		ConsolePrintf("%s", message);
+#else
+		printf("%s", message);
+#endif
+	}
+
+	///=====================================================
+	/// Registers the calling thread on first use; the only lock a thread ever takes for tracing
+	///=====================================================
+	ThreadTraceBuffer* RegisterCurrentThread(){
+		if (s_currentThreadBuffer == nullptr){
+			std::lock_guard<std::mutex> registryLock(s_registryMutex);
+			s_threadBuffers.push_back(std::unique_ptr<ThreadTraceBuffer>(new ThreadTraceBuffer((int)s_threadBuffers.size())));
+			s_currentThreadBuffer = s_threadBuffers.back().get();
+		}
+		return s_currentThreadBuffer;
+	}
+}
+
+///=====================================================
+/// The capture starts at the next FinishFrame, so the file always holds whole frames
+///=====================================================
+void TraceCapture::StartCapture(int numFrames, const char* fileName){
+	FATAL_ASSERT(numFrames > 0 && fileName != nullptr);
+	if (IsCapturing())
+		s_isCapturing.store(false);
+
+	s_numFramesToCapture = numFrames;
+	s_numFramesCaptured = 0;
+	s_fileName = fileName;
+}
+
+///=====================================================
+/// Also registers the thread and allocates its buffer, so call it as the thread starts rather than mid-frame
+///=====================================================
+void TraceCapture::NameCurrentThread(const std::string& threadName){
+	ThreadTraceBuffer* buffer = RegisterCurrentThread();
+	std::lock_guard<std::mutex> registryLock(s_registryMutex);
+	buffer->m_threadName = threadName;
+}
+
+///=====================================================
+/// Scopes on threads that never called NameCurrentThread are counted as dropped
+///=====================================================
+void TraceCapture::RecordScope(const char* name, const Clock::time_point& startTime, const Clock::time_point& endTime){
+	ThreadTraceBuffer* buffer = s_currentThreadBuffer;
+	if (buffer == nullptr){
+		s_numUnregisteredEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	int eventIndex = buffer->m_numEvents.load(std::memory_order_relaxed);
+	if (eventIndex >= MAX_EVENTS_PER_THREAD){
+		buffer->m_numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	TraceEvent& event = buffer->m_events[eventIndex];
+	event.m_name = name;
+	event.m_startTime = startTime;
+	event.m_endTime = endTime;
+	buffer->m_numEvents.store(eventIndex + 1, std::memory_order_release);
+}
+
+///=====================================================
+///
+///=====================================================
+void TraceCapture::BeginCapture(){
+	std::lock_guard<std::mutex> registryLock(s_registryMutex);
+	for (std::vector<std::unique_ptr<ThreadTraceBuffer> >::iterator bufferIter = s_threadBuffers.begin(); bufferIter != s_threadBuffers.end(); ++bufferIter){
+		(*bufferIter)->m_numEvents.store(0, std::memory_order_relaxed);
+		(*bufferIter)->m_numDroppedEvents.store(0, std::memory_order_relaxed);
+	}
+	s_numUnregisteredEvents.store(0, std::memory_order_relaxed);
+
+	s_captureStartTime = Clock::now();
+	s_isCapturing.store(true);
+}
+
+///=====================================================
+/// Call once per frame, after the frame's outermost scope has closed
+///=====================================================
+void TraceCapture::FinishFrame(){
+	if (s_numFramesToCapture <= 0)
+		return;
+
+	if (!IsCapturing()){
+		BeginCapture();
+		return;
+	}
+
+	++s_numFramesCaptured;
+	if (s_numFramesCaptured < s_numFramesToCapture)
+		return;
+
+	s_isCapturing.store(false);
+	s_numFramesToCapture = 0;
+	if (!WriteCapture()){
+		std::string message = "Failed to write trace to " + s_fileName + "\n";
+		PrintTraceMessage(message.c_str());
+	}
+}
+
+///=====================================================
+/// Complete ("X") events with microsecond timestamps from the start of the capture, plus a name for every thread
+///=====================================================
+bool TraceCapture::WriteCapture(){
+	FILE* file = fopen(s_fileName.c_str(), "w");
+	if (file == nullptr)
+		return false;
+
+	int numEventsWritten = 0;
+	int numEventsDropped = s_numUnregisteredEvents.load(std::memory_order_relaxed);
+	const char* separator = "";
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> registryLock(s_registryMutex);
+	for (std::vector<std::unique_ptr<ThreadTraceBuffer> >::const_iterator bufferIter = s_threadBuffers.begin(); bufferIter != s_threadBuffers.end(); ++bufferIter){
+		const ThreadTraceBuffer& buffer = **bufferIter;
+		int numEvents = buffer.m_numEvents.load(std::memory_order_acquire);
+		numEventsDropped += buffer.m_numDroppedEvents.load(std::memory_order_relaxed);
+
+		const char* threadName = buffer.m_threadName.empty() ? "Thread" : buffer.m_threadName.c_str();
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", separator, buffer.m_threadID, threadName);
+		separator = ",\n";
+
+		for (int eventIndex = 0; eventIndex < numEvents; ++eventIndex){
+			const TraceEvent& event = buffer.m_events[eventIndex];
+			double startMicroseconds = std::chrono::duration<double, std::micro>(event.m_startTime - s_captureStartTime).count();
+			double durationMicroseconds = std::chrono::duration<double, std::micro>(event.m_endTime - event.m_startTime).count();
+
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", separator, event.m_name, buffer.m_threadID, startMicroseconds, durationMicroseconds);
+		}
+		numEventsWritten += numEvents;
+	}
+
+	fprintf(file, "\n]}\n");
+	bool didWrite = (ferror(file) == 0);
+	fclose(file);
+
+	if (didWrite){
+		char message[512];
+		snprintf(message, sizeof(message), "Wrote %d trace events over %d frames to %s (%d dropped for lack of buffer space or from unnamed threads)\n", numEventsWritten, s_numFramesCaptured, s_fileName.c_str(), numEventsDropped);
+		PrintTraceMessage(message);
+	}
+	return didWrite;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+//=====================================================
+// TraceCapture.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_TraceCapture__
+#define __included_TraceCapture__
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#define TRACE_CONCATENATE_INNER(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_INNER(a, b)
+//name must be a string literal, or otherwise outlive the capture
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+
+///=====================================================
+/// Records every TRACE_SCOPE, on every thread, for a fixed number of frames and writes them out as a Chrome trace-event JSON file
+/// (chrome://tracing or ui.perfetto.dev). Each thread appends only to its own buffer, so recording a scope takes no locks.
+/// Only threads that called NameCurrentThread are recorded; that call allocates the thread's buffer up front.
+/// StartCapture and FinishFrame must be called on the main thread while no ParallelFor is running.
+///=====================================================
+class TraceCapture{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	static const int MAX_EVENTS_PER_THREAD;
+
+	static void StartCapture(int numFrames, const char* fileName);
+	static void FinishFrame();
+	static void NameCurrentThread(const std::string& threadName);
+
+	static inline bool IsCapturing(){ return s_isCapturing.load(std::memory_order_relaxed); }
+	static inline bool IsCapturePending(){ return s_numFramesToCapture > 0; }
+
+	static void RecordScope(const char* name, const Clock::time_point& startTime, const Clock::time_point& endTime);
+
+private:
+	static std::atomic<bool> s_isCapturing;
+	static int s_numFramesToCapture;
+	static int s_numFramesCaptured;
+	static std::string s_fileName;
+	static Clock::time_point s_captureStartTime;
+
+	static void BeginCapture();
+	static bool WriteCapture();
+};
+
+///=====================================================
+/// Times its own lifetime; costs one relaxed load when no capture is running
+///=====================================================
+class TraceScope{
+private:
+	const char* m_name;
+	TraceCapture::Clock::time_point m_startTime;
+	bool m_isRecording;
+
+public:
+	inline explicit TraceScope(const char* name);
+	inline ~TraceScope();
+};
+
+
+///=====================================================
+///
+///=====================================================
+TraceScope::TraceScope(const char* name) :
+m_name(name),
+m_startTime(),
+m_isRecording(TraceCapture::IsCapturing()){
+	if (m_isRecording)
+		m_startTime = TraceCapture::Clock::now();
+}
+
+///=====================================================
+///
+///=====================================================
+TraceScope::~TraceScope(){
+	if (m_isRecording)
+		TraceCapture::RecordScope(m_name, m_startTime, TraceCapture::Clock::now());
+}
+
+#endif
\ No newline at end of file
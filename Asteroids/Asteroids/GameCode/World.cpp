@@ -5,47 +5,114 @@
 
 #include "Engine/Core/EngineCore.hpp"
 #include "World.hpp"
-#include "Engine/Math/MathUtils.hpp"
 #include "Engine/Math/Disc2D.hpp"
 #include "Engine/Math/Math2D.hpp"
-#include "Engine/Time/Time.hpp"
+#include "Ship.hpp"
+#include "JobSystem.hpp"
+#include "TraceCapture.hpp"
+#include "AllocationTracker.hpp"
+#include "EntityKernels.hpp"
+#include <chrono>
+#ifndef ASTEROIDS_HEADLESS
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Renderer/OpenGLRenderer.hpp"
-#include "Ship.hpp"
+#include "Engine/Console/Console.hpp"
+#include "Engine/Console/ConsoleCommands.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#endif
+
+World* s_theWorld = nullptr;
+
+const double World::SIMULATION_TICK_SECONDS = 1.0 / 60.0;
+const int World::FIRST_STAGE_ASTEROIDS = 6;
+const int World::ENTITIES_PER_INTEGRATE_JOB = 4096;
+const int World::ASTEROIDS_PER_COLLISION_JOB = 256;
+const float World::VIEW_GRID_CELL_SIZE = 128.0f;
+
+typedef std::chrono::steady_clock PhaseClock;
 
 ///=====================================================
 /// 
 ///=====================================================
-World::World(const Vec2& displaySize, OpenGLRenderer* renderer) :
-m_isRunning(true),
-m_displaySize(displaySize),
-m_stage(6),
-m_ship(nullptr),
-m_bullets(),
+static inline double GetSecondsSince(const PhaseClock::time_point& startTime){
+	return std::chrono::duration<double>(PhaseClock::now() - startTime).count();
+}
+
+///=====================================================
+/// jobSystem may be null to run every tick on the calling thread; the results are identical either way
+///=====================================================
+World::World(const Vec2& worldSize, OpenGLRenderer* renderer, unsigned int seed, JobSystem* jobSystem, int maxBullets) :
+m_worldSize(worldSize),
+m_displaySize(worldSize),
+m_stage(FIRST_STAGE_ASTEROIDS),
+m_seed(seed),
+m_random(seed),
+m_pendingInput(),
+m_inputRecorder(),
+m_didLastReplayMatch(false),
 m_asteroids(),
+m_ship(nullptr),
+m_bullets(maxBullets),
+m_simulationSeconds(0.0),
 m_renderer(renderer),
+#ifndef ASTEROIDS_HEADLESS
 m_material(),
-m_objectToWorld(nullptr){
-	FATAL_ASSERT(m_renderer != nullptr);
-	m_material.CreateProgram(renderer, "Data/Shaders/basicAnim.vert", "Data/Shaders/basicAnim.frag");
-	m_material.CreateSampler(renderer);
-
-	m_material.SetBaseShape(GL_LINE_LOOP);
+m_objectToWorld(nullptr),
+m_bulletMesh(),
+m_frameUniforms(),
+m_instancedRenderer(),
+m_bulletBatchID(-1),
+m_isInstancingEnabled(false),
+m_worldToCameraUniform(nullptr),
+m_cameraPosition(0.0f, 0.0f),
+m_asteroidViewGrid(),
+m_visibleAsteroids(),
+m_visibleBullets(),
+#endif
+m_jobSystem(jobSystem),
+m_bulletGrid(),
+m_nearbyBulletsPerThread((jobSystem != nullptr) ? jobSystem->GetNumThreads() : 1),
+m_hitCandidatesPerJob(),
+m_lastPhaseTimes(),
+m_isRunning(true){
+	FATAL_ASSERT(s_theWorld == nullptr);
+	s_theWorld = this;
+
+	//entities only wrap once they are a full radius outside the world, so the grid covers the world plus the largest radius on every side
+	float largestRadius = Asteroid::BASE_ASTEROID_RADIUS * Asteroid::ASTEROID_SIZE_LARGE;
+	m_bulletGrid.Initialize(Vec2(-largestRadius, -largestRadius), Vec2(m_worldSize.x + largestRadius, m_worldSize.y + largestRadius), 2.0f * largestRadius);
+
+#ifndef ASTEROIDS_HEADLESS
+	if (m_renderer != nullptr)
+		StartupRendering();
+#else
+	FATAL_ASSERT(m_renderer == nullptr);
+#endif
 
-	UniformMatrix* projection = (UniformMatrix*)m_material.CreateUniform("u_cameraToClip");
-	FATAL_ASSERT(projection != nullptr);
-	projection->m_data.push_back(renderer->CreateOrthographicMatrix());
+	SpawnShip();
+	Restart(seed);
+}
 
-	m_objectToWorld = (UniformMatrix*)m_material.CreateUniform("u_objectToWorld");
-	FATAL_ASSERT(m_objectToWorld != nullptr);
-	m_objectToWorld->m_data.push_back(Matrix4());
+///=====================================================
+/// Puts the world back in the state it was constructed in, as if with this seed
+///=====================================================
+void World::Restart(unsigned int seed){
+	m_seed = seed;
+	m_random.Seed(seed);
+	m_pendingInput = TickInput();
+	m_simulationSeconds = 0.0;
+	m_stage = FIRST_STAGE_ASTEROIDS;
 
-	UniformMatrix* worldToCamera = (UniformMatrix*)m_material.CreateUniform("u_worldToCamera");
-	FATAL_ASSERT(worldToCamera != nullptr);
-	worldToCamera->m_data.push_back(Matrix4());
+	m_asteroids.Clear();
+	m_bullets.Clear();
+	if (m_ship) m_ship->Respawn(Vec2(m_worldSize.x*0.5f, m_worldSize.y*0.5f));
 
-	SpawnShip();
 	CreateStage();
+#ifndef ASTEROIDS_HEADLESS
+	BuildAsteroidViewGrid();
+#endif
 }
 
 ///=====================================================
@@ -54,136 +121,188 @@ m_objectToWorld(nullptr){
 void World::SpawnAsteroid(){
 	Vec2 position;
 	float asteroidRadius = Asteroid::BASE_ASTEROID_RADIUS * Asteroid::ASTEROID_SIZE_LARGE;
-	if (GetRandomIntLessThan(3)){ // 66% chance for bottom/top, 33% for left/right
-		position = Vec2(GetRandomFloatInRange(0.0f,m_displaySize.x), -asteroidRadius);
+	if (m_random.GetIntLessThan(3)){ // 66% chance for bottom/top, 33% for left/right
+		position = Vec2(m_random.GetFloatInRange(0.0f,m_worldSize.x), -asteroidRadius);
 	}
 	else{
-		position = Vec2(-asteroidRadius, GetRandomFloatInRange(0.0f,m_displaySize.y));
+		position = Vec2(-asteroidRadius, m_random.GetFloatInRange(0.0f,m_worldSize.y));
 	}
 
-	FATAL_ASSERT(m_renderer != nullptr);
-	Asteroid* asteroid = new Asteroid(position, Asteroid::ASTEROID_SIZE_LARGE, *m_renderer, m_material);
-
-	m_asteroids.push_back(asteroid);
+	m_asteroids.Add(position, Asteroid::ASTEROID_SIZE_LARGE, m_random);
 }
 
 ///=====================================================
 /// 
 ///=====================================================
 void World::SpawnShip(){
-	Vec2 position(m_displaySize.x*0.5f, m_displaySize.y*0.5f);
+	Vec2 position(m_worldSize.x*0.5f, m_worldSize.y*0.5f);
 
-	FATAL_ASSERT(m_renderer != nullptr);
-	m_ship = new Ship(position, *m_renderer, m_material);
+#ifndef ASTEROIDS_HEADLESS
+	m_ship = new Ship(position, m_renderer, (m_renderer != nullptr) ? &m_material : nullptr);
+#else
+	m_ship = new Ship(position, nullptr, nullptr);
+#endif
 }
 
 ///=====================================================
 /// 
 ///=====================================================
-void World::SpawnBullet(){
-	if (!m_ship) return;
-
-	FATAL_ASSERT(m_renderer != nullptr);
-	Bullet* bullet = m_ship->SpawnBullet(*m_renderer, m_material);
+void World::RespawnShip(){
+	if (m_ship && m_ship->IsDestroyed()) m_ship->Respawn(Vec2(m_worldSize.x*0.5f, m_worldSize.y*0.5f));
+}
 
-	m_bullets.push_back(bullet);
+///=====================================================
+/// 
+///=====================================================
+bool World::IsShipDestroyed() const{
+	return m_ship == nullptr || m_ship->IsDestroyed();
 }
 
+///=====================================================
+/// 
+///=====================================================
+void World::SpawnBullet(){
+	if (!m_ship) return;
 
+	m_bullets.Add(m_ship->GetBulletSpawnPosition(), m_ship->GetOrientationDegrees(), m_simulationSeconds); //shot is dropped if the pool is full
+}
 
 ///=====================================================
-/// 
+/// Fires a bullet from anywhere, as if by the ship; used to build large scenes for benchmarking
 ///=====================================================
-void World::Draw() const{
-	for (Asteroids::const_iterator asteroidIter = m_asteroids.begin(); asteroidIter != m_asteroids.end(); ++asteroidIter){
-		Asteroid* asteroid = *asteroidIter;
-		asteroid->Draw(m_material, m_objectToWorld);
-	}
-	if (m_ship && !m_ship->IsDestroyed()) m_ship->Draw(m_material, m_objectToWorld);
-	for (Bullets::const_iterator bulletIter = m_bullets.begin(); bulletIter != m_bullets.end(); ++bulletIter){
-		Bullet* bullet = *bulletIter;
-		bullet->Draw(m_material, m_objectToWorld);
-	}
+void World::SpawnBulletAt(const Vec2& position, float orientationDegrees){
+	m_bullets.Add(position, orientationDegrees, m_simulationSeconds); //shot is dropped if the pool is full
 }
 
+
 ///=====================================================
 /// 
 ///=====================================================
 World::~World(){
-	for (Asteroids::const_iterator asteroidIter = m_asteroids.begin(); asteroidIter != m_asteroids.end(); ++asteroidIter){
-		delete *asteroidIter;
-	}
 	if (m_ship) delete m_ship;
-	for (Bullets::const_iterator bulletIter = m_bullets.begin(); bulletIter != m_bullets.end(); ++bulletIter){
-		delete *bulletIter;
-	}
+
+#ifndef ASTEROIDS_HEADLESS
+	m_instancedRenderer.Shutdown();
+	m_frameUniforms.Shutdown();
+#endif
+
+	if (s_theWorld == this)
+		s_theWorld = nullptr;
 }
 
 ///=====================================================
 /// 
 ///=====================================================
 void World::Update(double deltaSeconds){
-	FATAL_ASSERT(m_renderer != nullptr);
-	for (Asteroids::iterator asteroidIter = m_asteroids.begin(); asteroidIter != m_asteroids.end(); ++asteroidIter){
-		Asteroid* asteroid = *asteroidIter;
-		asteroid->Update(deltaSeconds, *m_renderer);
-		CheckForGameEntityWrapping(asteroid);
+	TRACE_SCOPE("World::Update");
+	ALLOCATION_SCOPE("World::Update");
+	PhaseClock::time_point updateStartTime = PhaseClock::now();
+
+	TickInput input = m_pendingInput;
+	m_pendingInput.m_buttons &= TickInput::HELD_BUTTONS;
+
+	if (m_inputRecorder.IsReplaying()){
+		m_inputRecorder.GetNextReplayTick(input);
+		deltaSeconds = m_inputRecorder.GetTickSeconds();
 	}
+	else if (m_inputRecorder.IsRecording()){
+		FATAL_ASSERT(deltaSeconds == m_inputRecorder.GetTickSeconds());
+		m_inputRecorder.RecordTick(input);
+	}
+	ApplyInput(input);
+
+	m_simulationSeconds += deltaSeconds;
+
+	PhaseClock::time_point integrateStartTime = PhaseClock::now();
+	IntegrateAndWrap(m_asteroids, (float)deltaSeconds);
 
 	if (m_ship && !m_ship->IsDestroyed()){
-		m_ship->Update(deltaSeconds, *m_renderer);
+		m_ship->Update(deltaSeconds, m_renderer);
 		CheckForGameEntityWrapping(m_ship);
 	}
 
-	double currentTime = GetCurrentSeconds();
-	double minimumSpawnTime = currentTime - 2.0;
-	for (Bullets::iterator bulletIter = m_bullets.begin(); bulletIter != m_bullets.end();){
-		Bullet* bullet = *bulletIter;
-		if (bullet->GetSpawnTime() < minimumSpawnTime){
-			delete bullet;
-			bulletIter = m_bullets.erase(bulletIter);
-		}
-		else{
-			bullet->Update(deltaSeconds, *m_renderer);
-			CheckForGameEntityWrapping(bullet);
-			++bulletIter;
-		}
-	}
+	double minimumSpawnTime = m_simulationSeconds - Bullet::BULLET_LIFETIME_SECONDS;
+	m_bullets.ExpireSpawnedBefore(minimumSpawnTime);
 
+	IntegrateAndWrap(m_bullets, (float)deltaSeconds);
+	m_lastPhaseTimes.m_integrateSeconds = GetSecondsSince(integrateStartTime);
+
+	PhaseClock::time_point collisionStartTime = PhaseClock::now();
 	CheckForCollisions();
+	m_lastPhaseTimes.m_collisionSeconds = GetSecondsSince(collisionStartTime);
 
-	if (m_asteroids.empty()){
+	if (m_asteroids.IsEmpty()){
 		m_stage += 3;
 		CreateStage();
 	}
+
+	if (m_inputRecorder.IsReplaying() && m_inputRecorder.IsReplayFinished())
+		FinishReplay();
+
+#ifndef ASTEROIDS_HEADLESS
+	BuildAsteroidViewGrid();
+#endif
+	m_lastPhaseTimes.m_updateSeconds = GetSecondsSince(updateStartTime);
 }
 
 ///=====================================================
 /// 
 ///=====================================================
 void World::ProcessInput() {
-	if (s_theInputSystem->IsKeyDown('A') || s_theInputSystem->IsKeyDown(VK_LEFT)) {
+#ifndef ASTEROIDS_HEADLESS
+	//held keys are resampled every frame; presses stay latched until a tick consumes them
+	unsigned char buttons = m_pendingInput.m_buttons & ~(TickInput::BUTTON_ROTATE_COUNTERCLOCKWISE | TickInput::BUTTON_ROTATE_CLOCKWISE | TickInput::BUTTON_THRUST | TickInput::BUTTON_FIRE);
+
+	if (s_theInputSystem->IsKeyDown('A') || s_theInputSystem->IsKeyDown(VK_LEFT)) buttons |= TickInput::BUTTON_ROTATE_COUNTERCLOCKWISE;
+	if (s_theInputSystem->IsKeyDown('D') || s_theInputSystem->IsKeyDown(VK_RIGHT)) buttons |= TickInput::BUTTON_ROTATE_CLOCKWISE;
+	if (s_theInputSystem->IsKeyDown('W') || s_theInputSystem->IsKeyDown(VK_UP)) buttons |= TickInput::BUTTON_THRUST;
+	if (s_theInputSystem->IsKeyDown(VK_SPACE)) buttons |= TickInput::BUTTON_FIRE;
+	if (s_theInputSystem->GetKeyWentDown('P')) buttons |= TickInput::BUTTON_RESPAWN;
+	if (s_theInputSystem->GetKeyWentDown('O')) buttons |= TickInput::BUTTON_SPAWN_ASTEROID;
+	if (s_theInputSystem->GetKeyWentDown('L')) buttons |= TickInput::BUTTON_DESTROY_ASTEROID;
+
+	m_pendingInput.m_buttons = buttons;
+#endif
+}
+
+///=====================================================
+/// Applies one tick of input; keyboard actions keep their original priority, so only the first one held is used
+///=====================================================
+void World::ApplyInput(const TickInput& input){
+	if (input.IsButtonDown(TickInput::BUTTON_ROTATE_COUNTERCLOCKWISE)) {
 		if (m_ship) m_ship->RotateCounterClockwise();
 	}
-	else if (s_theInputSystem->IsKeyDown('D') || s_theInputSystem->IsKeyDown(VK_RIGHT)) {
+	else if (input.IsButtonDown(TickInput::BUTTON_ROTATE_CLOCKWISE)) {
 		if (m_ship) m_ship->RotateClockwise();
 	}
-	else if (s_theInputSystem->IsKeyDown('W') || s_theInputSystem->IsKeyDown(VK_UP)) {
+	else if (input.IsButtonDown(TickInput::BUTTON_THRUST)) {
 		if (m_ship) m_ship->SetThrust(1.0f);
 	}
 
-	else if (s_theInputSystem->IsKeyDown(VK_SPACE)) {
+	else if (input.IsButtonDown(TickInput::BUTTON_FIRE)) {
 		if (m_ship && !m_ship->IsDestroyed()) SpawnBullet();
 	}
 
-	else if (s_theInputSystem->GetKeyWentDown('P')) {
-		if (m_ship && m_ship->IsDestroyed()) m_ship->Respawn(Vec2(m_displaySize.x*0.5f, m_displaySize.y*0.5f));
+	else if (input.IsButtonDown(TickInput::BUTTON_RESPAWN)) {
+		RespawnShip();
 	}
-	else if (s_theInputSystem->GetKeyWentDown('O')) {
+	else if (input.IsButtonDown(TickInput::BUTTON_SPAWN_ASTEROID)) {
 		SpawnAsteroid();
 	}
-	else if (s_theInputSystem->GetKeyWentDown('L')) {
-		DestroyAsteroid(m_asteroids.end() - 1);
+	else if (input.IsButtonDown(TickInput::BUTTON_DESTROY_ASTEROID)) {
+		if (!m_asteroids.IsEmpty()) DestroyAsteroid(m_asteroids.Size() - 1);
+	}
+
+	if (m_ship && !m_ship->IsDestroyed()){
+		float percentJoystickX = input.GetJoystickX();
+		float percentJoystickY = input.GetJoystickY();
+		if (percentJoystickX != 0.0f || percentJoystickY != 0.0f){
+			Vec2 heading(percentJoystickX, percentJoystickY);
+			m_ship->SetOrientationDegrees(heading.CalcHeadingDegrees());
+
+			m_ship->SetThrust(heading.CalcLength());
+		}
+		if (input.IsButtonDown(TickInput::BUTTON_CONTROLLER_FIRE)) SpawnBullet();
 	}
 }
 
@@ -197,20 +316,21 @@ void World::CheckForGameEntityWrapping(GameEntity* gameEntity){
 	float radius = gameEntity->GetRadius();
 
 	if (gameEntityPosition.x + radius < 0.0f){
-		gameEntityPosition.x = m_displaySize.x + radius;
+		gameEntityPosition.x = m_worldSize.x + radius;
 	}
-	else if (gameEntityPosition.x - radius > m_displaySize.x){
+	else if (gameEntityPosition.x - radius > m_worldSize.x){
 		gameEntityPosition.x = -radius;
 	}
 
 	if (gameEntityPosition.y + radius < 0.0f){
-		gameEntityPosition.y = m_displaySize.y + radius;
+		gameEntityPosition.y = m_worldSize.y + radius;
 	}
-	else if (gameEntityPosition.y - radius > m_displaySize.y){
+	else if (gameEntityPosition.y - radius > m_worldSize.y){
 		gameEntityPosition.y = -radius;
 	}
 
-	gameEntity->SetPosition(gameEntityPosition);
+	if (gameEntityPosition.x != gameEntity->GetPosition().x || gameEntityPosition.y != gameEntity->GetPosition().y)
+		gameEntity->SetPosition(gameEntityPosition);
 }
 
 ///=====================================================
@@ -225,104 +345,610 @@ void World::CreateStage(){
 ///=====================================================
 /// 
 ///=====================================================
-void World::DestroyAsteroid(Asteroids::iterator asteroidIndex){
-	Asteroid* asteroid = *asteroidIndex;
-	delete asteroid;
-	m_asteroids.erase(asteroidIndex);
+void World::DestroyAsteroid(int asteroidIndex){
+	m_asteroids.RemoveAt(asteroidIndex);
 }
 
 ///=====================================================
-/// 
+/// Shrinks the asteroid to the next size down and appends its other half to the end of m_asteroids
+/// Returns false if the asteroid was already the smallest size and should be destroyed instead
 ///=====================================================
-void World::CheckForCollisions(){
-	FATAL_ASSERT(m_renderer != nullptr);
-	Asteroids asteroidsToAdd;
-	for (Asteroids::iterator asteroidIter = m_asteroids.begin(); asteroidIter != m_asteroids.end();){
-		Asteroid* asteroid = *asteroidIter;
-		if (!asteroid) break;
+bool World::SplitAsteroid(int asteroidIndex){
+	int shrunkSize = m_asteroids.m_sizes[asteroidIndex] - 1;
+	if (shrunkSize <= 0)
+		return false;
 
-		for (Bullets::iterator bulletIter = m_bullets.begin(); bulletIter != m_bullets.end();){
-			Bullet* bullet = *bulletIter;
-			if (!bullet) break;
+	Vec2 position = m_asteroids.m_positions[asteroidIndex];
+	Vec2 oldVelocity = m_asteroids.m_velocities[asteroidIndex];
 
-			Disc2D asteroidDisc(asteroid->GetPosition(), asteroid->GetRadius());
-			Disc2D bulletDisc(bullet->GetPosition(), bullet->GetRadius());
+	int newAsteroidIndex = m_asteroids.Add(position, (Asteroid::AsteroidSize)shrunkSize, m_random);
+	m_asteroids.Reset(asteroidIndex, position, (Asteroid::AsteroidSize)shrunkSize, m_random);
+
+	Vec2 splitVelocity = m_asteroids.m_velocities[asteroidIndex];
+	m_asteroids.m_velocities[newAsteroidIndex] = oldVelocity + splitVelocity;
+	m_asteroids.m_velocities[asteroidIndex] = oldVelocity - splitVelocity;
+	return true;
+}
 
+///=====================================================
+/// Integrates the live window of one entity type, split into ranges across the job system's threads when there is one
+///=====================================================
+template <typename Store>
+void World::IntegrateAndWrap(Store& entities, float deltaSeconds){
+	TRACE_SCOPE("World::IntegrateAndWrap");
+	int firstIndex = EntityKernel<Store>::GetFirstIndex(entities);
+	if (m_jobSystem == nullptr){
+		entities.IntegrateAndWrap(deltaSeconds, m_worldSize, firstIndex, entities.Size());
+		return;
+	}
+
+	m_jobSystem->ParallelFor(entities.Size() - firstIndex, ENTITIES_PER_INTEGRATE_JOB, [&](int firstJobIndex, int endJobIndex, int /*threadIndex*/){
+		entities.IntegrateAndWrap(deltaSeconds, m_worldSize, firstIndex + firstJobIndex, firstIndex + endJobIndex);
+	});
+}
+
+///=====================================================
+/// Fills out_candidates with every asteroid and bullet pair whose discs overlap, sorted by asteroid and then bullet index
+/// Ranges of asteroids are searched in parallel into per-job buffers, which are appended in range order so the result doesn't depend on scheduling
+/// The per-job buffers stay members since worker threads fill them; only the merged list, which the main thread builds, comes from the frame arena
+///=====================================================
+void World::FindHitCandidates(int numAsteroids, FrameVector<HitCandidate>& out_candidates){
+	TRACE_SCOPE("World::FindHitCandidates");
+	out_candidates.clear();
+	if (m_bullets.GetNumAlive() == 0 || numAsteroids == 0)
+		return;
+
+	int numJobs = 1;
+	if (m_jobSystem == nullptr){
+		if (m_hitCandidatesPerJob.empty())
+			m_hitCandidatesPerJob.resize(1);
+		m_hitCandidatesPerJob[0].clear();
+		FindHitCandidatesInRange(0, numAsteroids, m_nearbyBulletsPerThread[0], m_hitCandidatesPerJob[0]);
+	}
+	else{
+		numJobs = (numAsteroids + ASTEROIDS_PER_COLLISION_JOB - 1) / ASTEROIDS_PER_COLLISION_JOB;
+		if ((int)m_hitCandidatesPerJob.size() < numJobs)
+			m_hitCandidatesPerJob.resize(numJobs);
+
+		m_jobSystem->ParallelFor(numAsteroids, ASTEROIDS_PER_COLLISION_JOB, [&](int firstIndex, int endIndex, int threadIndex){
+			std::vector<HitCandidate>& jobCandidates = m_hitCandidatesPerJob[firstIndex / ASTEROIDS_PER_COLLISION_JOB];
+			jobCandidates.clear();
+			FindHitCandidatesInRange(firstIndex, endIndex, m_nearbyBulletsPerThread[threadIndex], jobCandidates);
+		});
+	}
+
+	//sized exactly up front so the arena hands out one block instead of every step of the vector's growth
+	size_t numCandidates = 0;
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex){
+		numCandidates += m_hitCandidatesPerJob[jobIndex].size();
+	}
+	out_candidates.reserve(numCandidates);
+
+	for (int jobIndex = 0; jobIndex < numJobs; ++jobIndex){
+		const std::vector<HitCandidate>& jobCandidates = m_hitCandidatesPerJob[jobIndex];
+		out_candidates.insert(out_candidates.end(), jobCandidates.begin(), jobCandidates.end());
+	}
+}
+
+///=====================================================
+/// Read-only, so any number of ranges can run at once
+/// m_bulletGrid holds only the bullet window, so its entries are offset from the pool's indices by the window's first index
+///=====================================================
+void World::FindHitCandidatesInRange(int firstAsteroidIndex, int endAsteroidIndex, std::vector<int>& nearbyBullets, std::vector<HitCandidate>& out_candidates) const{
+	int firstBulletIndex = m_bullets.GetFirstIndex();
+
+	for (int asteroidIndex = firstAsteroidIndex; asteroidIndex < endAsteroidIndex; ++asteroidIndex){
+		Disc2D asteroidDisc(m_asteroids.m_positions[asteroidIndex], m_asteroids.m_radii[asteroidIndex]);
+
+		m_bulletGrid.QueryDisc(asteroidDisc.m_center, asteroidDisc.m_radius + Bullet::BULLET_RADIUS, nearbyBullets);
+		for (std::vector<int>::const_iterator nearbyIter = nearbyBullets.begin(); nearbyIter != nearbyBullets.end(); ++nearbyIter){
+			int bulletIndex = firstBulletIndex + *nearbyIter;
+			if (!m_bullets.m_isAlive[bulletIndex]) continue;
+
+			Disc2D bulletDisc(m_bullets.m_positions[bulletIndex], m_bullets.m_radii[bulletIndex]);
 			if (DoDiscsOverlap(asteroidDisc, bulletDisc)){
-				delete bullet;
-				bulletIter = m_bullets.erase(bulletIter);
-
-				int shrunkSize = asteroid->GetSize() - 1;
-				if (shrunkSize > 0){
-  					Asteroid* newAsteroid = new Asteroid(asteroid->GetPosition(), (Asteroid::AsteroidSize)shrunkSize, *m_renderer, m_material);
-					asteroidsToAdd.push_back(newAsteroid);
-
-					Vec2 oldVelocity = asteroid->GetVelocity();
-					*asteroid = Asteroid(asteroid->GetPosition(), (Asteroid::AsteroidSize)shrunkSize, *m_renderer, m_material);
-
-					newAsteroid->SetVelocity(oldVelocity + asteroid->GetVelocity());
-					asteroid->SetVelocity(oldVelocity - asteroid->GetVelocity());
-				}
-				else{
-					delete asteroid;
-					asteroidIter = m_asteroids.erase(asteroidIter);
-					goto nextAsteroid;
-				}
-			}
-			else{
-				++bulletIter;
+				HitCandidate candidate;
+				candidate.m_asteroidIndex = asteroidIndex;
+				candidate.m_bulletIndex = bulletIndex;
+				out_candidates.push_back(candidate);
 			}
 		}
-			
-		if (m_ship && !m_ship->IsDestroyed()){
-			Disc2D asteroidDisc(asteroid->GetPosition(), asteroid->GetRadius());
-			Disc2D shipDisc(m_ship->GetPosition(), m_ship->GetRadius());
-
-			if (DoDiscsOverlap(asteroidDisc, shipDisc)){
-				int shrunkSize = asteroid->GetSize() - 1;
-				if (shrunkSize > 0){
-					Asteroid* newAsteroid = new Asteroid(asteroid->GetPosition(), (Asteroid::AsteroidSize)shrunkSize, *m_renderer, m_material);
-					asteroidsToAdd.push_back(newAsteroid);
-
-					Vec2 oldVelocity = asteroid->GetVelocity();
-					*asteroid = Asteroid(asteroid->GetPosition(), (Asteroid::AsteroidSize)shrunkSize, *m_renderer, m_material);
-
-					newAsteroid->SetVelocity(oldVelocity + asteroid->GetVelocity());
-					asteroid->SetVelocity(oldVelocity - asteroid->GetVelocity());
-				}
-				else{
-					asteroidIter = m_asteroids.erase(asteroidIter);
-					delete asteroid;
-				}
-
-				m_ship->Destroy();
-			}
-			else {
-				++asteroidIter;
+	}
+}
+
+///=====================================================
+/// Bullets are bucketed into m_bulletGrid so each asteroid only tests the bullets in its neighboring cells
+/// The candidate search can run in parallel; hits are then resolved serially in asteroid order, since a split shrinks the asteroid and uses the RNG
+/// Hit bullets become tombstones in place; hit asteroids are only flagged during the pass and swap-removed afterwards, so indices stay valid throughout
+///=====================================================
+void World::CheckForCollisions(){
+	TRACE_SCOPE("World::CheckForCollisions");
+	ALLOCATION_SCOPE("World::CheckForCollisions");
+	int numBulletsInWindow = m_bullets.Size() - m_bullets.GetFirstIndex();
+	m_bulletGrid.Build(numBulletsInWindow > 0 ? &m_bullets.m_positions[m_bullets.GetFirstIndex()] : nullptr, numBulletsInWindow);
+
+	//both lists are only needed for this tick, so they come from the frame arena
+	FrameVector<HitCandidate> hitCandidates;
+	FrameVector<int> asteroidsToRemove;
+
+	//halves added by splits go on the end and aren't tested until next tick
+	int numAsteroids = m_asteroids.Size();
+	FindHitCandidates(numAsteroids, hitCandidates);
+
+	FrameVector<HitCandidate>::const_iterator candidateIter = hitCandidates.begin();
+	for (int asteroidIndex = 0; asteroidIndex < numAsteroids; ++asteroidIndex){
+		bool isAsteroidDestroyed = false;
+
+		for (; candidateIter != hitCandidates.end() && candidateIter->m_asteroidIndex == asteroidIndex; ++candidateIter){
+			int bulletIndex = candidateIter->m_bulletIndex;
+			if (isAsteroidDestroyed || !m_bullets.m_isAlive[bulletIndex]) continue;
+
+			//rebuilt per bullet since a split shrinks the asteroid
+			Disc2D asteroidDisc(m_asteroids.m_positions[asteroidIndex], m_asteroids.m_radii[asteroidIndex]);
+			Disc2D bulletDisc(m_bullets.m_positions[bulletIndex], m_bullets.m_radii[bulletIndex]);
+
+			if (DoDiscsOverlap(asteroidDisc, bulletDisc)){
+				m_bullets.Kill(bulletIndex);
+
+				if (!SplitAsteroid(asteroidIndex))
+					isAsteroidDestroyed = true;
 			}
 		}
-		else {
-			++asteroidIter;
+
+		if (isAsteroidDestroyed){
+			asteroidsToRemove.push_back(asteroidIndex);
+			continue;
+		}
+		if (!m_ship || m_ship->IsDestroyed()) continue;
+
+		Disc2D asteroidDisc(m_asteroids.m_positions[asteroidIndex], m_asteroids.m_radii[asteroidIndex]);
+		Disc2D shipDisc(m_ship->GetPosition(), m_ship->GetRadius());
+		if (DoDiscsOverlap(asteroidDisc, shipDisc)){
+			if (!SplitAsteroid(asteroidIndex))
+				asteroidsToRemove.push_back(asteroidIndex);
+
+			m_ship->Destroy();
 		}
-nextAsteroid:;
 	}
 
-	for (Asteroids::iterator asteroidIter = asteroidsToAdd.begin(); asteroidIter != asteroidsToAdd.end(); ++asteroidIter){
-		m_asteroids.push_back(*asteroidIter);
+	//remove from the back so the swapped-in entity is never one that still needs removing
+	for (FrameVector<int>::const_reverse_iterator removeIter = asteroidsToRemove.rbegin(); removeIter != asteroidsToRemove.rend(); ++removeIter){
+		m_asteroids.RemoveAt(*removeIter);
 	}
 }
 
 ///=====================================================
-/// 
+/// The controller state is held until the next call and applied by every tick in between
 ///=====================================================
 void World::ProcessXBoxController(float percentJoystickX, float percentJoystickY, unsigned short isAButtonDown){
+	m_pendingInput.SetJoystick(percentJoystickX, percentJoystickY);
+
+	if (isAButtonDown)
+		m_pendingInput.m_buttons |= TickInput::BUTTON_CONTROLLER_FIRE;
+	else
+		m_pendingInput.m_buttons &= ~TickInput::BUTTON_CONTROLLER_FIRE;
+}
+
+///=====================================================
+/// Restarts the world with seed and records every tick's input from here on
+///=====================================================
+void World::StartRecording(unsigned int seed, double tickSeconds){
+	Restart(seed);
+	m_inputRecorder.StartRecording(seed, tickSeconds);
+}
+
+///=====================================================
+/// 
+///=====================================================
+bool World::StopRecording(const char* fileName){
+	if (!m_inputRecorder.IsRecording())
+		return false;
+
+	return m_inputRecorder.StopRecording(fileName, CalcStateChecksum());
+}
+
+///=====================================================
+/// Restarts the world with the recording's seed; live input is ignored until every recorded tick has played
+///=====================================================
+bool World::StartReplay(const char* fileName){
+	if (!m_inputRecorder.StartReplay(fileName))
+		return false;
+
+	Restart(m_inputRecorder.GetSeed());
+	if (m_inputRecorder.IsReplayFinished())
+		FinishReplay();
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void World::FinishReplay(){
+	unsigned int checksum = CalcStateChecksum();
+	m_didLastReplayMatch = (checksum == m_inputRecorder.GetFinalChecksum());
+	m_inputRecorder.Stop();
+
+#ifndef ASTEROIDS_HEADLESS
+	ConsolePrintf("Replay of %u ticks finished: %s (0x%08x)\n", m_inputRecorder.GetNumTicks(), m_didLastReplayMatch ? "matched" : "DIVERGED", checksum);
+#endif
+}
+
+///=====================================================
+/// FNV-1a over the raw bytes of a block of simulation state
+///=====================================================
+static unsigned int HashBytes(unsigned int hash, const void* data, size_t numBytes){
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex){
+		hash ^= bytes[byteIndex];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+///=====================================================
+/// 
+///=====================================================
+template <typename T>
+static unsigned int HashVector(unsigned int hash, const std::vector<T>& values){
+	return values.empty() ? hash : HashBytes(hash, &values[0], sizeof(T) * values.size());
+}
+
+///=====================================================
+/// Bit-exact fingerprint of everything the simulation depends on; two runs match only if every float matches
+///=====================================================
+unsigned int World::CalcStateChecksum() const{
+	unsigned int hash = 2166136261u;
+	hash = HashBytes(hash, &m_stage, sizeof(m_stage));
+	hash = HashBytes(hash, &m_simulationSeconds, sizeof(m_simulationSeconds));
+
+	hash = HashVector(hash, m_asteroids.m_positions);
+	hash = HashVector(hash, m_asteroids.m_velocities);
+	hash = HashVector(hash, m_asteroids.m_orientationsDegrees);
+	hash = HashVector(hash, m_asteroids.m_angularVelocities);
+	hash = HashVector(hash, m_asteroids.m_sizes);
+	hash = HashVector(hash, m_asteroids.m_shapes);
+
+	//only live bullets; tombstones and the expired prefix are storage details that depend on when the window last slid back
+	int numBullets = m_bullets.Size();
+	for (int bulletIndex = m_bullets.GetFirstIndex(); bulletIndex < numBullets; ++bulletIndex){
+		if (!m_bullets.m_isAlive[bulletIndex]) continue;
+
+		hash = HashBytes(hash, &m_bullets.m_positions[bulletIndex], sizeof(Vec2));
+		hash = HashBytes(hash, &m_bullets.m_velocities[bulletIndex], sizeof(Vec2));
+		hash = HashBytes(hash, &m_bullets.m_spawnTimes[bulletIndex], sizeof(double));
+	}
+
+	if (m_ship){
+		bool isShipDestroyed = m_ship->IsDestroyed();
+		float shipOrientationDegrees = m_ship->GetOrientationDegrees();
+		hash = HashBytes(hash, &m_ship->GetPosition(), sizeof(Vec2));
+		hash = HashBytes(hash, &shipOrientationDegrees, sizeof(shipOrientationDegrees));
+		hash = HashBytes(hash, &isShipDestroyed, sizeof(isShipDestroyed));
+	}
+
+	return hash;
+}
+
+#ifndef ASTEROIDS_HEADLESS
+///=====================================================
+/// 
+///=====================================================
+void World::StartupRendering(){
+	m_displaySize = Vec2(m_renderer->GetDisplayWidth(), m_renderer->GetDisplayHeight());
+
+	//asteroids are re-bucketed every tick so drawing only visits the cells around the view
+	float largestRadius = Asteroid::BASE_ASTEROID_RADIUS * Asteroid::ASTEROID_SIZE_LARGE;
+	m_asteroidViewGrid.Initialize(Vec2(-largestRadius, -largestRadius), Vec2(m_worldSize.x + largestRadius, m_worldSize.y + largestRadius), VIEW_GRID_CELL_SIZE);
+
+	//outlines only read position and color, so they skip the skinning and lighting inputs of the basicAnim shaders
+	m_material.CreateProgram(m_renderer, "Data/Shaders/basic2DLine.vert", "Data/Shaders/basic2DLine.frag");
+	m_material.CreateSampler(m_renderer);
+
+	m_material.SetBaseShape(GL_LINE_LOOP);
+
+	UniformMatrix* projection = (UniformMatrix*)m_material.CreateUniform("u_cameraToClip");
+	FATAL_ASSERT(projection != nullptr);
+	projection->m_data.push_back(m_renderer->CreateOrthographicMatrix());
+
+	m_objectToWorld = (UniformMatrix*)m_material.CreateUniform("u_objectToWorld");
+	FATAL_ASSERT(m_objectToWorld != nullptr);
+	m_objectToWorld->m_data.push_back(Matrix4());
+
+	m_worldToCameraUniform = (UniformMatrix*)m_material.CreateUniform("u_worldToCamera");
+	FATAL_ASSERT(m_worldToCameraUniform != nullptr);
+	m_worldToCameraUniform->m_data.push_back(Matrix4());
+
+	for (int shape = 0; shape < Asteroid::NUM_ASTEROID_SHAPES; ++shape){
+		Asteroid::CreateMesh((Asteroid::AsteroidShape)shape, m_renderer, m_material, m_asteroidMeshes[shape]);
+	}
+	Bullet::CreateMesh(m_renderer, m_material, m_bulletMesh);
+	CreateInstanceBatches();
+}
+
+///=====================================================
+/// Instanced drawing builds the INSTANCED and FRAME_UNIFORMS variant of the line shaders; if that fails we keep drawing per object
+///=====================================================
+void World::CreateInstanceBatches(){
+	for (int shape = 0; shape < Asteroid::NUM_ASTEROID_SHAPES; ++shape){
+		m_asteroidBatchIDs[shape] = -1;
+	}
+
+	if (!m_frameUniforms.Startup() || !m_instancedRenderer.Startup("Data/Shaders/basic2DLine.vert", "Data/Shaders/basic2DLine.frag", GL_LINE_LOOP)){
+		m_frameUniforms.Shutdown();
+		ConsolePrintf("Instanced rendering unavailable, drawing per object\n");
+		return;
+	}
+
+	std::vector<Vertex_Anim> vertices;
+	for (int shape = 0; shape < Asteroid::NUM_ASTEROID_SHAPES; ++shape){
+		Asteroid::CreateVertices((Asteroid::AsteroidShape)shape, vertices);
+		m_asteroidBatchIDs[shape] = m_instancedRenderer.CreateBatch(vertices);
+	}
+
+	vertices.clear();
+	Bullet::CreateVertices(vertices);
+	m_bulletBatchID = m_instancedRenderer.CreateBatch(vertices);
+
+	//same pixel-space projection as OpenGLRenderer::CreateOrthographicMatrix, column-major
+	for (int i = 0; i < 16; ++i){
+		m_cameraToClip[i] = 0.0f;
+		m_worldToCamera[i] = 0.0f;
+	}
+	m_cameraToClip[0] = 2.0f / m_displaySize.x;
+	m_cameraToClip[5] = 2.0f / m_displaySize.y;
+	m_cameraToClip[10] = -1.0f;
+	m_cameraToClip[12] = -1.0f;
+	m_cameraToClip[13] = -1.0f;
+	m_cameraToClip[15] = 1.0f;
+
+	m_worldToCamera[0] = m_worldToCamera[5] = m_worldToCamera[10] = m_worldToCamera[15] = 1.0f;
+
+	m_isInstancingEnabled = true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void World::SetInstancingEnabled(bool isEnabled){
+	m_isInstancingEnabled = isEnabled && m_instancedRenderer.IsRunning();
+}
+
+///=====================================================
+/// Only asteroids are bucketed here; bullets reuse m_bulletGrid, which CheckForCollisions already built from this tick's positions
+///=====================================================
+void World::BuildAsteroidViewGrid(){
+	if (m_renderer == nullptr) return;
+	m_asteroidViewGrid.Build(m_asteroids.IsEmpty() ? nullptr : &m_asteroids.m_positions[0], m_asteroids.Size());
+}
+
+///=====================================================
+/// 
+///=====================================================
+static float ClampCameraAxis(float cameraMin, float worldExtent, float viewExtent){
+	if (viewExtent >= worldExtent)
+		return 0.5f * (worldExtent - viewExtent);
+	if (cameraMin < 0.0f)
+		return 0.0f;
+	if (cameraMin > worldExtent - viewExtent)
+		return worldExtent - viewExtent;
+	return cameraMin;
+}
+
+///=====================================================
+/// Centers the view on the ship without showing past the world's edges, and holds still while the ship is destroyed
+///=====================================================
+void World::UpdateCamera(float interpolationFraction){
 	if (m_ship && !m_ship->IsDestroyed()){
-		if (percentJoystickX != 0.0f || percentJoystickY != 0.0f){
-			Vec2 heading(percentJoystickX, percentJoystickY);
-			m_ship->SetOrientationDegrees(heading.CalcHeadingDegrees());
+		Vec2 shipPosition = m_ship->GetInterpolatedPosition(interpolationFraction);
+		m_cameraPosition = Vec2(shipPosition.x - 0.5f * m_displaySize.x, shipPosition.y - 0.5f * m_displaySize.y);
+	}
+	m_cameraPosition.x = ClampCameraAxis(m_cameraPosition.x, m_worldSize.x, m_displaySize.x);
+	m_cameraPosition.y = ClampCameraAxis(m_cameraPosition.y, m_worldSize.y, m_displaySize.y);
 
-			m_ship->SetThrust(heading.CalcLength());
+	Matrix4 worldToCamera;
+	worldToCamera.Translate(Vec2(-m_cameraPosition.x, -m_cameraPosition.y));
+	m_worldToCameraUniform->m_data[0] = worldToCamera;
+	if (m_ship) m_ship->SetWorldToCamera(worldToCamera);
+
+	m_worldToCamera[12] = -m_cameraPosition.x;
+	m_worldToCamera[13] = -m_cameraPosition.y;
+}
+
+///=====================================================
+/// Drops grid entries past the end of their store, which only happens if entities were removed without a tick since
+///=====================================================
+static void OffsetAndTrimIndices(std::vector<int>& indices, int offset, int endIndex){
+	size_t numKept = 0;
+	for (size_t entry = 0; entry < indices.size(); ++entry){
+		int index = offset + indices[entry];
+		if (index < endIndex)
+			indices[numKept++] = index;
+	}
+	indices.resize(numKept);
+}
+
+///=====================================================
+/// Collects the asteroids and bullets in grid cells around the view, padded by the largest radius so anything partly on screen is kept
+///=====================================================
+void World::FindVisibleEntities(){
+	float padding = Asteroid::BASE_ASTEROID_RADIUS * Asteroid::ASTEROID_SIZE_LARGE;
+	Vec2 viewMins(m_cameraPosition.x - padding, m_cameraPosition.y - padding);
+	Vec2 viewMaxs(m_cameraPosition.x + m_displaySize.x + padding, m_cameraPosition.y + m_displaySize.y + padding);
+
+	m_asteroidViewGrid.QueryBox(viewMins, viewMaxs, m_visibleAsteroids);
+	OffsetAndTrimIndices(m_visibleAsteroids, 0, m_asteroids.Size());
+
+	//m_bulletGrid holds only the bullet window, so its entries are offset by the window's first index
+	m_bulletGrid.QueryBox(viewMins, viewMaxs, m_visibleBullets);
+	OffsetAndTrimIndices(m_visibleBullets, m_bullets.GetFirstIndex(), m_bullets.Size());
+}
+
+///=====================================================
+/// Gathers one transform per visible asteroid and bullet into their shape's batch
+///=====================================================
+void World::BuildInstances(float interpolationFraction){
+	m_instancedRenderer.ClearInstances();
+	AddInstances(m_asteroids, m_visibleAsteroids, m_asteroidBatchIDs, interpolationFraction);
+	AddInstances(m_bullets, m_visibleBullets, &m_bulletBatchID, interpolationFraction);
+}
+
+///=====================================================
+/// batchIDs holds one batch per shape index of the entity type
+///=====================================================
+template <typename Store>
+void World::AddInstances(const Store& entities, const std::vector<int>& indices, const int* batchIDs, float interpolationFraction){
+	typedef EntityKernel<Store> Kernel;
+	for (std::vector<int>::const_iterator indexIter = indices.begin(); indexIter != indices.end(); ++indexIter){
+		int index = *indexIter;
+		if (!Kernel::IsAlive(entities, index)) continue;
+
+		InstanceTransform instance(entities.GetInterpolatedPosition(index, interpolationFraction), entities.m_orientationsDegrees[index], Kernel::GetScale(entities, index));
+		m_instancedRenderer.AddInstance(batchIDs[Kernel::GetShapeIndex(entities, index)], instance);
+	}
+}
+
+///=====================================================
+/// One draw per asteroid shape plus one for all bullets; the lone ship still goes through the material
+///=====================================================
+void World::DrawInstanced(float interpolationFraction){
+	BuildInstances(interpolationFraction);
+	m_frameUniforms.Update(m_cameraToClip, m_worldToCamera);
+	m_instancedRenderer.Render();
+
+	if (m_ship && !m_ship->IsDestroyed()) m_ship->Draw(m_material, m_objectToWorld, interpolationFraction);
+}
+
+///=====================================================
+/// interpolationFraction is how far this frame is between the last two ticks, in [0,1)
+///=====================================================
+void World::Draw(float interpolationFraction){
+	if (m_renderer == nullptr) return;
+	TRACE_SCOPE("World::Draw");
+	ALLOCATION_SCOPE("World::Draw");
+
+	PhaseClock::time_point drawStartTime = PhaseClock::now();
+	UpdateCamera(interpolationFraction);
+	FindVisibleEntities();
+
+	if (m_isInstancingEnabled){
+		DrawInstanced(interpolationFraction);
+	}
+	else{
+		DrawPerObject(interpolationFraction);
+	}
+	m_lastPhaseTimes.m_drawSeconds = GetSecondsSince(drawStartTime);
+}
+
+///=====================================================
+/// One draw call and one uniform upload per visible entity
+///=====================================================
+void World::DrawPerObject(float interpolationFraction) const{
+	FATAL_ASSERT(m_objectToWorld != nullptr);
+	DrawEntitiesPerObject(m_asteroids, m_visibleAsteroids, m_asteroidMeshes, interpolationFraction);
+
+	if (m_ship && !m_ship->IsDestroyed()) m_ship->Draw(m_material, m_objectToWorld, interpolationFraction);
+
+	DrawEntitiesPerObject(m_bullets, m_visibleBullets, &m_bulletMesh, interpolationFraction);
+}
+
+///=====================================================
+/// meshes holds one mesh per shape index of the entity type
+///=====================================================
+template <typename Store>
+void World::DrawEntitiesPerObject(const Store& entities, const std::vector<int>& indices, const EngineAndrew::Mesh* meshes, float interpolationFraction) const{
+	typedef EntityKernel<Store> Kernel;
+	for (std::vector<int>::const_iterator indexIter = indices.begin(); indexIter != indices.end(); ++indexIter){
+		int index = *indexIter;
+		if (!Kernel::IsAlive(entities, index)) continue;
+
+		Matrix4 modelMatrix = Matrix4::CreateScale(Kernel::GetScale(entities, index));
+		modelMatrix.RotateDegreesAboutZ(entities.m_orientationsDegrees[index]);
+		modelMatrix.Translate(entities.GetInterpolatedPosition(index, interpolationFraction));
+		m_objectToWorld->m_data[0] = modelMatrix;
+
+		m_material.Render(meshes[Kernel::GetShapeIndex(entities, index)]);
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+CONSOLE_COMMAND(INSTANCING){
+	if (s_theWorld == nullptr) return false;
+
+	if (args->m_args != nullptr){
+		if (args->m_args[0] != "1")
+			return false;
+
+		std::string argument = args->m_args[1];
+		std::transform(argument.begin(), argument.end(), argument.begin(), ::tolower);
+
+		if (argument == "on"){
+			s_theWorld->SetInstancingEnabled(true);
 		}
-		if (isAButtonDown) SpawnBullet();
+		else if (argument == "off"){
+			s_theWorld->SetInstancingEnabled(false);
+		}
+		else{
+			return false;
+		}
+	}
+	else{
+		s_theWorld->SetInstancingEnabled(!s_theWorld->IsInstancingEnabled());
+	}
+
+	ConsolePrintf("Instancing %s\n", s_theWorld->IsInstancingEnabled() ? "on" : "off");
+	return true;
+}
+
+///=====================================================
+/// Restarts the world and starts recording; pass a seed to reuse one, otherwise a new one is picked
+///=====================================================
+CONSOLE_COMMAND(RECORD_START){
+	if (s_theWorld == nullptr) return false;
+
+	unsigned int seed = (unsigned int)time(nullptr);
+	if (args->m_args != nullptr){
+		if (args->m_args[0] != "1")
+			return false;
+		seed = (unsigned int)strtoul(args->m_args[1].c_str(), nullptr, 10);
+	}
+
+	s_theWorld->StartRecording(seed, World::SIMULATION_TICK_SECONDS);
+	ConsolePrintf("Recording with seed %u\n", seed);
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+CONSOLE_COMMAND(RECORD_STOP){
+	if (s_theWorld == nullptr) return false;
+	if (args->m_args == nullptr || args->m_args[0] != "1") return false;
+
+	unsigned int numTicks = s_theWorld->GetInputRecorder().GetNumTicks();
+	if (!s_theWorld->StopRecording(args->m_args[1].c_str())){
+		ConsolePrintf("Failed to save recording to %s\n", args->m_args[1].c_str());
+		return false;
 	}
+
+	ConsolePrintf("Saved %u ticks to %s (0x%08x)\n", numTicks, args->m_args[1].c_str(), s_theWorld->GetInputRecorder().GetFinalChecksum());
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+CONSOLE_COMMAND(REPLAY){
+	if (s_theWorld == nullptr) return false;
+	if (args->m_args == nullptr || args->m_args[0] != "1") return false;
+
+	if (!s_theWorld->StartReplay(args->m_args[1].c_str())){
+		ConsolePrintf("Failed to load recording %s\n", args->m_args[1].c_str());
+		return false;
+	}
+
+	ConsolePrintf("Replaying %u ticks with seed %u\n", s_theWorld->GetInputRecorder().GetNumTicks(), s_theWorld->GetSeed());
+	return true;
 }
+#endif
\ No newline at end of file
@@ -11,43 +11,170 @@
 #include "Engine/Math/Vec2.hpp"
 #include "Asteroid.hpp"
 class Ship;
+class GameEntity;
+class JobSystem;
 #include "Bullet.hpp"
+#include "CollisionGrid.hpp"
+#include "RandomGenerator.hpp"
+#include "InputRecorder.hpp"
+#include "FrameArena.hpp"
+#ifndef ASTEROIDS_HEADLESS
 #include "Engine/Renderer/Material.hpp"
+#include "InstancedRenderer.hpp"
+#include "FrameUniformBuffer.hpp"
+#else
+class OpenGLRenderer;
+#endif
 
+///=====================================================
+/// Wall-clock seconds spent in each phase of the most recent Update and Draw
+///=====================================================
+struct WorldPhaseTimes{
+	double m_updateSeconds; //the whole tick, including the phases below
+	double m_integrateSeconds; //moving, wrapping and expiring asteroids, bullets and the ship
+	double m_collisionSeconds;
+	double m_drawSeconds;
+
+	WorldPhaseTimes() :
+		m_updateSeconds(0.0),
+		m_integrateSeconds(0.0),
+		m_collisionSeconds(0.0),
+		m_drawSeconds(0.0){
+	}
+};
+
+///=====================================================
+/// Runs without graphics when constructed with a null renderer; building with ASTEROIDS_HEADLESS strips the render code entirely
+/// The world can be any size; when drawn, a display-sized camera follows the ship and only the entities near it are submitted
+/// Each Update is one simulation tick driven only by the seed and the TickInput of each tick, so a recorded session replays exactly
+///=====================================================
 class World{
+public:
+	const static double SIMULATION_TICK_SECONDS;
+	const static int FIRST_STAGE_ASTEROIDS;
+
 private:
+	const static int ENTITIES_PER_INTEGRATE_JOB;
+	const static int ASTEROIDS_PER_COLLISION_JOB;
+	const static float VIEW_GRID_CELL_SIZE;
+
+	struct HitCandidate{
+		int m_asteroidIndex;
+		int m_bulletIndex;
+	};
+
+	Vec2 m_worldSize;
 	Vec2 m_displaySize;
 	int m_stage;
-	Asteroids m_asteroids;
+	unsigned int m_seed;
+	RandomGenerator m_random;
+	TickInput m_pendingInput;
+	InputRecorder m_inputRecorder;
+	bool m_didLastReplayMatch;
+	AsteroidStore m_asteroids;
 	Ship* m_ship;
-	Bullets m_bullets;
+	BulletPool m_bullets;
+	double m_simulationSeconds;
 	OpenGLRenderer* m_renderer;
+
+#ifndef ASTEROIDS_HEADLESS
 	EngineAndrew::Material m_material;
 	UniformMatrix* m_objectToWorld;
+	//bound to m_material, so they are created and released with this World
+	EngineAndrew::Mesh m_asteroidMeshes[Asteroid::NUM_ASTEROID_SHAPES];
+	EngineAndrew::Mesh m_bulletMesh;
+
+	FrameUniformBuffer m_frameUniforms;
+	InstancedRenderer m_instancedRenderer;
+	int m_asteroidBatchIDs[Asteroid::NUM_ASTEROID_SHAPES];
+	int m_bulletBatchID;
+	bool m_isInstancingEnabled;
+	float m_cameraToClip[16];
+	float m_worldToCamera[16];
+
+	//the camera follows the ship; only the entities in grid cells it overlaps are drawn
+	UniformMatrix* m_worldToCameraUniform;
+	Vec2 m_cameraPosition; //world position of the view's bottom left corner
+	CollisionGrid m_asteroidViewGrid;
+	std::vector<int> m_visibleAsteroids;
+	std::vector<int> m_visibleBullets;
+#endif
+
+	JobSystem* m_jobSystem;
+	CollisionGrid m_bulletGrid;
+	std::vector<std::vector<int> > m_nearbyBulletsPerThread;
+	std::vector<std::vector<HitCandidate> > m_hitCandidatesPerJob;
+	WorldPhaseTimes m_lastPhaseTimes;
 
 	bool m_isRunning;
 
-	void SpawnAsteroid();
 	void SpawnShip();
 	void SpawnBullet();
 	void CreateStage();
 
-	void DestroyAsteroid(Asteroids::iterator asteroidIndex);
+	void DestroyAsteroid(int asteroidIndex);
+	void ApplyInput(const TickInput& input);
+	void FinishReplay();
 
 	void CheckForGameEntityWrapping(GameEntity* gameEntity);
+	template <typename Store> void IntegrateAndWrap(Store& entities, float deltaSeconds);
 	void CheckForCollisions();
+	void FindHitCandidates(int numAsteroids, FrameVector<HitCandidate>& out_candidates);
+	void FindHitCandidatesInRange(int firstAsteroidIndex, int endAsteroidIndex, std::vector<int>& nearbyBullets, std::vector<HitCandidate>& out_candidates) const;
+	bool SplitAsteroid(int asteroidIndex);
+
+#ifndef ASTEROIDS_HEADLESS
+	void StartupRendering();
+	void CreateInstanceBatches();
+	void BuildAsteroidViewGrid();
+	void UpdateCamera(float interpolationFraction);
+	void FindVisibleEntities();
+	void BuildInstances(float interpolationFraction);
+	template <typename Store> void AddInstances(const Store& entities, const std::vector<int>& indices, const int* batchIDs, float interpolationFraction);
+	void DrawInstanced(float interpolationFraction);
+	void DrawPerObject(float interpolationFraction) const;
+	template <typename Store> void DrawEntitiesPerObject(const Store& entities, const std::vector<int>& indices, const EngineAndrew::Mesh* meshes, float interpolationFraction) const;
+#endif
 
 public:
-	World(const Vec2& displaySize, OpenGLRenderer* renderer);
+	World(const Vec2& worldSize, OpenGLRenderer* renderer, unsigned int seed, JobSystem* jobSystem = nullptr, int maxBullets = Bullet::MAX_BULLETS);
 	~World();
 
+	void Restart(unsigned int seed);
 	void Update(double deltaSeconds);
 	void ProcessInput();
+	void RespawnShip();
+	void SpawnAsteroid();
+	void SpawnBulletAt(const Vec2& position, float orientationDegrees);
+
+	void StartRecording(unsigned int seed, double tickSeconds);
+	bool StopRecording(const char* fileName);
+	bool StartReplay(const char* fileName);
+	inline const InputRecorder& GetInputRecorder() const{ return m_inputRecorder; }
+	inline bool DidLastReplayMatch() const{ return m_didLastReplayMatch; }
+	inline unsigned int GetSeed() const{ return m_seed; }
+	unsigned int CalcStateChecksum() const;
 
-	void Draw() const;
+#ifndef ASTEROIDS_HEADLESS
+	void Draw(float interpolationFraction);
+	void SetInstancingEnabled(bool isEnabled);
+	inline bool IsInstancingEnabled() const{ return m_isInstancingEnabled; }
+	inline int GetNumVisibleAsteroids() const{ return (int)m_visibleAsteroids.size(); }
+	inline int GetNumVisibleBullets() const{ return (int)m_visibleBullets.size(); }
+#endif
 
 	void ProcessXBoxController(float percentJoystickX, float percentJoystickY, unsigned short isAButtonDown);
 	inline bool IsRunning() const { return m_isRunning; }
+
+	inline const Vec2& GetWorldSize() const{ return m_worldSize; }
+	inline int GetStage() const{ return m_stage; }
+	inline int GetNumAsteroids() const{ return m_asteroids.Size(); }
+	inline int GetNumBullets() const{ return m_bullets.GetNumAlive(); }
+	inline double GetSimulationSeconds() const{ return m_simulationSeconds; }
+	inline const WorldPhaseTimes& GetLastPhaseTimes() const{ return m_lastPhaseTimes; }
+	bool IsShipDestroyed() const;
 };
 
+extern World* s_theWorld;
+
 #endif
\ No newline at end of file
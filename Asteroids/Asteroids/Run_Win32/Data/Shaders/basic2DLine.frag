@@ -0,0 +1,9 @@
+#version 330 core
+
+in vec4 passColor;
+
+out vec4 outColor;
+
+void main( void ){
+	outColor = passColor;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#version 330 core
+
+//INSTANCED (defined by ShaderProgramCache) reads each object's transform from a per-instance attribute instead of u_objectToWorld
+//FRAME_UNIFORMS reads the view and projection from the FrameMatrices uniform buffer, uploaded once per frame, instead of plain uniforms
+
+#ifdef FRAME_UNIFORMS
+layout(std140) uniform FrameMatrices{
+	mat4 u_cameraToClip; //projection matrix
+	mat4 u_worldToCamera; //view matrix
+};
+#else
+uniform mat4 u_cameraToClip; //projection matrix
+uniform mat4 u_worldToCamera; //view matrix
+#endif
+
+#ifdef INSTANCED
+in vec2 inPosition; //object space
+in vec4 inInstanceTransform; //per instance: world position xy, orientation degrees, uniform scale
+#else
+uniform mat4 u_objectToWorld; //model matrix
+
+in vec3 inRestPosition; //object space
+#endif
+in vec4 inColor;
+
+out vec4 passColor;
+
+void main( void ){
+#ifdef INSTANCED
+	//same order as the per-object path: scale, then rotate about z, then translate
+	float orientationRadians = radians(inInstanceTransform.z);
+	float c = cos(orientationRadians);
+	float s = sin(orientationRadians);
+
+	vec2 scaled = inPosition * inInstanceTransform.w;
+	vec2 rotated = vec2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+	vec4 pos = vec4(rotated + inInstanceTransform.xy, 0.0f, 1.0f);
+#else
+	vec4 pos = u_objectToWorld * vec4(inRestPosition, 1.0f);
+#endif
+
+	passColor = inColor;
+	gl_Position = u_cameraToClip * u_worldToCamera * pos;
+}
\ No newline at end of file
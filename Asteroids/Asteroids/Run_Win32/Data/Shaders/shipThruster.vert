@@ -0,0 +1,18 @@
+#version 330 core
+
+uniform mat4 u_cameraToClip; //projection matrix
+uniform mat4 u_objectToWorld; //model matrix
+uniform mat4 u_worldToCamera; //view matrix
+uniform mat4 u_thrusterStretch; //uniform scale matrix; only [0][0] is read, as the stretch along the ship's axis
+
+in vec3 inRestPosition; //thruster space, base at the origin
+in vec4 inColor;
+
+out vec4 passColor;
+
+void main( void ){
+	vec4 pos = vec4(inRestPosition.x * u_thrusterStretch[0][0], inRestPosition.yz, 1.0f);
+
+	passColor = inColor;
+	gl_Position = u_cameraToClip * u_worldToCamera * u_objectToWorld * pos;
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+//=====================================================
+// DatagramShards.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "Engine/Console/Console.hpp"
+#include "DatagramShards.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static const int WAIT_TIMEOUT_MILLISECONDS = 100;
+
+const int DatagramShards::MAX_SHARDS_PER_CORE = 4;
+const int DatagramShards::DESCRIPTORS_PER_SHARD = 2;
+
+///=====================================================
+/// The cores this process may run on, which taskset or a cpuset can narrow below what the machine has
+///=====================================================
+static std::vector<int> GetAllowedCores(){
+	std::vector<int> allowedCores;
+
+	cpu_set_t cores;
+	CPU_ZERO(&cores);
+	if (sched_getaffinity(0, sizeof(cores), &cores) == 0){
+		for (int coreIndex = 0; coreIndex < CPU_SETSIZE; ++coreIndex){
+			if (CPU_ISSET(coreIndex, &cores))
+				allowedCores.push_back(coreIndex);
+		}
+	}
+	else{
+		ConsolePrintf("Failed to read the allowed cores: %s\n", strerror(errno));
+	}
+
+	if (allowedCores.empty()){
+		int numCores = (int)std::thread::hardware_concurrency();
+		for (int coreIndex = 0; coreIndex < numCores; ++coreIndex){
+			allowedCores.push_back(coreIndex);
+		}
+		if (allowedCores.empty())
+			allowedCores.push_back(0);
+	}
+	return allowedCores;
+}
+
+///=====================================================
+/// 
+///=====================================================
+DatagramShards::DatagramShards() :
+m_shards(),
+m_stopEventFD(-1),
+m_isRunning(false){
+}
+
+///=====================================================
+/// 
+///=====================================================
+DatagramShards::~DatagramShards(){
+	Stop();
+}
+
+///=====================================================
+/// Every shard is a thread, two descriptors and its own packet pool, so past a few per core they only add cost
+///=====================================================
+int DatagramShards::GetNumShardsToStart(int numShards){
+	int numCores = (int)GetAllowedCores().size();
+	if (numShards == 0)
+		return numCores;
+	return (numShards < MAX_SHARDS_PER_CORE * numCores) ? numShards : MAX_SHARDS_PER_CORE * numCores;
+}
+
+///=====================================================
+/// Returns false, with nothing left running, if any shard's port can't be bound
+///=====================================================
+bool DatagramShards::Start(int firstPort, int portSpan, int numShards, int batchSize){
+	FATAL_ASSERT(!IsRunning() && portSpan > 0 && numShards >= 0);
+
+	std::vector<int> allowedCores = GetAllowedCores();
+	int numCores = (int)allowedCores.size();
+	int numShardsToStart = GetNumShardsToStart(numShards);
+	if (numShards > numShardsToStart)
+		ConsolePrintf("%d shards asked for, starting %d for %d cores\n", numShards, numShardsToStart, numCores);
+	numShards = numShardsToStart;
+
+	//the last run's shards were only kept for their statistics
+	m_shards.clear();
+
+	m_stopEventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	FATAL_ASSERT(m_stopEventFD >= 0);
+
+	for (int shardIndex = 0; shardIndex < numShards; ++shardIndex){
+		std::unique_ptr<Shard> shard(new Shard());
+		shard->m_port = firstPort + shardIndex % portSpan;
+		shard->m_coreIndex = allowedCores[shardIndex % numCores];
+		shard->m_epollFD = -1;
+
+		char port[8];
+		snprintf(port, sizeof(port), "%d", shard->m_port);
+		shard->m_packetPool.Startup(DatagramSocket::PACKET_BUFFERS_PER_BATCH * batchSize, DatagramSocket::MAX_DATAGRAM_BYTES);
+		if (!shard->m_socket.Open(port, batchSize, shard->m_packetPool, true)){
+			shard->m_packetPool.Shutdown();
+			Stop();
+			return false;
+		}
+
+		shard->m_epollFD = epoll_create1(EPOLL_CLOEXEC);
+		FATAL_ASSERT(shard->m_epollFD >= 0);
+
+		epoll_event socketEvent;
+		socketEvent.events = EPOLLIN | EPOLLET;
+		socketEvent.data.fd = shard->m_socket.GetSocket();
+		epoll_ctl(shard->m_epollFD, EPOLL_CTL_ADD, shard->m_socket.GetSocket(), &socketEvent);
+
+		//level-triggered and never cleared, so one signal stops every worker
+		epoll_event stopEvent;
+		stopEvent.events = EPOLLIN;
+		stopEvent.data.fd = m_stopEventFD;
+		epoll_ctl(shard->m_epollFD, EPOLL_CTL_ADD, m_stopEventFD, &stopEvent);
+
+		m_shards.push_back(std::move(shard));
+	}
+
+	//every socket is bound before any worker starts, so the kernel spreads peers over all of them from the first datagram
+	m_isRunning.store(true);
+	for (std::vector<std::unique_ptr<Shard> >::iterator shardIter = m_shards.begin(); shardIter != m_shards.end(); ++shardIter){
+		Shard& shard = **shardIter;
+		shard.m_thread = std::thread(&DatagramShards::RunShard, this, std::ref(shard));
+
+		cpu_set_t cores;
+		CPU_ZERO(&cores);
+		CPU_SET(shard.m_coreIndex, &cores);
+		//the worker still runs unpinned, just without the cache and interrupt locality pinning buys
+		int pinResult = pthread_setaffinity_np(shard.m_thread.native_handle(), sizeof(cores), &cores);
+		if (pinResult != 0)
+			ConsolePrintf("Failed to pin the shard on port %d to core %d: %s\n", shard.m_port, shard.m_coreIndex, strerror(pinResult));
+	}
+
+	ConsolePrintf("Echoing datagrams on %d shards over ports %d to %d, %d per syscall\n", numShards, firstPort, firstPort + ((numShards < portSpan) ? numShards : portSpan) - 1, batchSize);
+	return true;
+}
+
+///=====================================================
+/// Joins every worker and closes its socket; the counters stay for PrintStatistics
+///=====================================================
+void DatagramShards::Stop(){
+	m_isRunning.store(false);
+	if (m_stopEventFD >= 0){
+		unsigned long long count = 1;
+		ssize_t numBytesWritten = write(m_stopEventFD, &count, sizeof(count));
+		(void)numBytesWritten;
+	}
+
+	for (std::vector<std::unique_ptr<Shard> >::iterator shardIter = m_shards.begin(); shardIter != m_shards.end(); ++shardIter){
+		Shard& shard = **shardIter;
+		if (shard.m_thread.joinable())
+			shard.m_thread.join();
+
+		if (shard.m_epollFD >= 0){
+			close(shard.m_epollFD);
+			shard.m_epollFD = -1;
+		}
+		if (shard.m_socket.IsOpen()){
+			shard.m_socket.Close();
+			shard.m_packetPool.Shutdown();
+		}
+	}
+
+	if (m_stopEventFD >= 0){
+		close(m_stopEventFD);
+		m_stopEventFD = -1;
+	}
+}
+
+///=====================================================
+/// Worker thread: the same batched zero-copy echo as EchoHost's, for the peers the kernel hands this shard
+///=====================================================
+void DatagramShards::RunShard(Shard& shard){
+	epoll_event events[2];
+	while (m_isRunning.load()){
+		int numEvents = epoll_wait(shard.m_epollFD, events, 2, WAIT_TIMEOUT_MILLISECONDS);
+		if (numEvents < 0 && errno != EINTR){
+			ConsolePrintf("Shard on port %d epoll_wait failed: %s\n", shard.m_port, strerror(errno));
+			return;
+		}
+
+		for (int eventIndex = 0; eventIndex < numEvents; ++eventIndex){
+			if (events[eventIndex].data.fd != shard.m_socket.GetSocket()) continue;
+
+			for (;;){
+				int numReceived = shard.m_socket.ReceiveBatch();
+				if (numReceived == 0)
+					break;
+
+				for (int packet = 0; packet < numReceived; ++packet){
+					shard.m_socket.QueueSend(shard.m_socket.GetReceivedAddress(packet), shard.m_socket.GetReceivedAddressLength(packet), shard.m_socket.GetReceivedPacket(packet));
+				}
+				shard.m_socket.FlushSends();
+			}
+		}
+	}
+}
+
+///=====================================================
+/// Call once stopped; an uneven split between shards on one port means few peers, since each peer always lands on the same shard
+///=====================================================
+void DatagramShards::PrintStatistics() const{
+	FATAL_ASSERT(!m_isRunning.load());
+
+	unsigned long long numReceived = 0;
+	unsigned long long numSent = 0;
+	for (std::vector<std::unique_ptr<Shard> >::const_iterator shardIter = m_shards.begin(); shardIter != m_shards.end(); ++shardIter){
+		numReceived += (*shardIter)->m_socket.GetNumPacketsReceived();
+		numSent += (*shardIter)->m_socket.GetNumPacketsSent();
+	}
+	ConsolePrintf("Datagram shards: %d, %llu received and %llu sent in total\n", (int)m_shards.size(), numReceived, numSent);
+
+	for (int shardIndex = 0; shardIndex < (int)m_shards.size(); ++shardIndex){
+		const Shard& shard = *m_shards[shardIndex];
+		ConsolePrintf("  Shard %d (port %d, core %d): ", shardIndex, shard.m_port, shard.m_coreIndex);
+		shard.m_socket.PrintStatistics();
+	}
+}
+#endif
\ No newline at end of file
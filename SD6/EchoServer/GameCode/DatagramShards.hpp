@@ -0,0 +1,63 @@
+//=====================================================
+// DatagramShards.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_DatagramShards__
+#define __included_DatagramShards__
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "DatagramSocket.hpp"
+#include "PacketPool.hpp"
+
+#ifdef __linux__
+///=====================================================
+/// Echoes datagrams from several sockets at once, each with its own worker thread pinned to its own core (Linux only)
+/// Shards share ports with SO_REUSEPORT, so the kernel pins each peer to one shard by a hash of its address and no two workers ever touch the same peer
+/// With a port span above 1 the shards are spread round-robin over that many ports from the first, for clients that pick a port themselves
+/// Every shard has its own packet pool, so workers share nothing but the stop flag
+///=====================================================
+class DatagramShards{
+private:
+	struct Shard{
+		PacketPool m_packetPool; //before m_socket, so the socket releases its buffers first
+		DatagramSocket m_socket;
+		int m_port;
+		int m_coreIndex;
+		int m_epollFD;
+		std::thread m_thread;
+	};
+
+	std::vector<std::unique_ptr<Shard> > m_shards;
+	int m_stopEventFD;
+	std::atomic<bool> m_isRunning;
+
+	DatagramShards(const DatagramShards&);
+	DatagramShards& operator=(const DatagramShards&);
+
+	void RunShard(Shard& shard);
+
+public:
+	DatagramShards();
+	~DatagramShards();
+
+	const static int MAX_SHARDS_PER_CORE;
+	const static int DESCRIPTORS_PER_SHARD; //its socket and epoll instance; all the shards also share one stop eventfd
+
+	//numShards 0 starts one per core the process is allowed to run on, and more than MAX_SHARDS_PER_CORE per core are capped; shards are pinned round-robin over those cores
+	static int GetNumShardsToStart(int numShards);
+	bool Start(int firstPort, int portSpan, int numShards, int batchSize);
+	void Stop();
+	inline bool IsRunning() const{ return m_isRunning.load(); }
+	inline int GetNumShards() const{ return (int)m_shards.size(); }
+
+	void PrintStatistics() const;
+};
+#endif
+
+#endif
\ No newline at end of file
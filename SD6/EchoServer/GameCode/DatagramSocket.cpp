@@ -0,0 +1,257 @@
+//=====================================================
+// DatagramSocket.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "Engine/Console/Console.hpp"
+#include "DatagramSocket.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <unistd.h>
+#include <utility>
+
+const int DatagramSocket::DEFAULT_BATCH_SIZE = 64;
+const int DatagramSocket::MAX_BATCH_SIZE = 1024; //UIO_MAXIOV; recvmmsg and sendmmsg take no more messages than this per call
+const size_t DatagramSocket::MAX_DATAGRAM_BYTES = 2048;
+const int DatagramSocket::PACKET_BUFFERS_PER_BATCH = 4;
+
+static const int SOCKET_BUFFER_BYTES = 4 * 1024 * 1024;
+
+///=====================================================
+/// 
+///=====================================================
+DatagramSocket::DatagramSocket() :
+m_socket(-1),
+m_batchSize(0),
+m_packetPool(nullptr),
+m_receiveSlots(),
+m_sendSlots(),
+m_messageHeaders(),
+m_ioVectors(),
+m_numReceived(0),
+m_numQueuedSends(0),
+m_numReceiveCalls(0),
+m_numPacketsReceived(0),
+m_numPacketsTruncated(0),
+m_numSendCalls(0),
+m_numPacketsSent(0),
+m_numPacketsDropped(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+DatagramSocket::~DatagramSocket(){
+	Close();
+}
+
+///=====================================================
+/// Binds every local interface on port; returns false if the port is taken
+/// packetPool must outlive the socket and have buffers of at least MAX_DATAGRAM_BYTES
+/// isPortShared sets SO_REUSEPORT, so every socket opened that way on the port gets its own share of the peers, split by a hash of their addresses
+///=====================================================
+bool DatagramSocket::Open(const char* port, int batchSize, PacketPool& packetPool, bool isPortShared){
+	FATAL_ASSERT(m_socket < 0 && batchSize > 0 && batchSize <= MAX_BATCH_SIZE && packetPool.GetBufferBytes() >= MAX_DATAGRAM_BYTES);
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(nullptr, port, &hints, &addresses) != 0){
+		ConsolePrintf("Failed to resolve port %s\n", port);
+		return false;
+	}
+
+	for (addrinfo* address = addresses; address != nullptr && m_socket < 0; address = address->ai_next){
+		int datagramSocket = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+		if (datagramSocket < 0) continue;
+
+		//bursts between batches queue in the kernel instead of being dropped; it caps this at net.core.rmem_max and wmem_max
+		setsockopt(datagramSocket, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+		setsockopt(datagramSocket, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_BYTES, sizeof(SOCKET_BUFFER_BYTES));
+		if (isPortShared){
+			int isEnabled = 1;
+			setsockopt(datagramSocket, SOL_SOCKET, SO_REUSEPORT, &isEnabled, sizeof(isEnabled));
+		}
+
+		if (bind(datagramSocket, address->ai_addr, address->ai_addrlen) != 0){
+			close(datagramSocket);
+			continue;
+		}
+		m_socket = datagramSocket;
+	}
+	freeaddrinfo(addresses);
+
+	if (m_socket < 0){
+		ConsolePrintf("Failed to bind UDP port %s: %s\n", port, strerror(errno));
+		return false;
+	}
+
+	//receive slots take their buffers on first use
+	m_batchSize = batchSize;
+	m_packetPool = &packetPool;
+	m_receiveSlots.resize(batchSize);
+	m_sendSlots.resize(batchSize);
+	m_messageHeaders.resize(batchSize);
+	m_ioVectors.resize(batchSize);
+	m_numReceived = 0;
+	m_numQueuedSends = 0;
+	return true;
+}
+
+///=====================================================
+/// Anything still queued is dropped, and every buffer goes back to the pool
+///=====================================================
+void DatagramSocket::Close(){
+	if (m_socket >= 0){
+		close(m_socket);
+		m_socket = -1;
+	}
+	m_receiveSlots.clear();
+	m_sendSlots.clear();
+	m_numReceived = 0;
+	m_numQueuedSends = 0;
+}
+
+///=====================================================
+/// Replaces the last batch with up to GetBatchSize datagrams in one recvmmsg; returns 0 once the socket would block
+/// Datagrams longer than MAX_DATAGRAM_BYTES are dropped
+/// Also returns 0 if the pool has no buffer for even one slot, leaving the datagrams in the socket
+///=====================================================
+int DatagramSocket::ReceiveBatch(){
+	FATAL_ASSERT(IsOpen());
+	m_numReceived = 0;
+
+	//an all-truncated batch still means the socket may have more
+	while (m_numReceived == 0){
+		int numSlots = 0;
+		for (; numSlots < m_batchSize; ++numSlots){
+			PacketSlot& packet = m_receiveSlots[numSlots];
+			//a buffer still referenced from the last batch belongs to whoever kept it now
+			if (packet.m_packet.IsEmpty() || !packet.m_packet.IsUnique()){
+				packet.m_packet = m_packetPool->Acquire();
+				if (packet.m_packet.IsEmpty())
+					break;
+			}
+
+			m_ioVectors[numSlots].iov_base = packet.m_packet.GetData();
+			m_ioVectors[numSlots].iov_len = MAX_DATAGRAM_BYTES;
+
+			msghdr& header = m_messageHeaders[numSlots].msg_hdr;
+			memset(&header, 0, sizeof(header));
+			header.msg_name = &packet.m_address;
+			header.msg_namelen = sizeof(packet.m_address);
+			header.msg_iov = &m_ioVectors[numSlots];
+			header.msg_iovlen = 1;
+		}
+		if (numSlots == 0)
+			return 0;
+
+		int numMessages = recvmmsg(m_socket, &m_messageHeaders[0], numSlots, MSG_DONTWAIT, nullptr);
+		if (numMessages < 0 && errno == EINTR) continue;
+		if (numMessages <= 0){
+			if (numMessages < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+				ConsolePrintf("recvmmsg failed: %s\n", strerror(errno));
+			return 0;
+		}
+		++m_numReceiveCalls;
+		m_numPacketsReceived += numMessages;
+
+		//compacted in place, so the kept packets stay in slots 0 to m_numReceived - 1
+		for (int message = 0; message < numMessages; ++message){
+			const mmsghdr& header = m_messageHeaders[message];
+			if ((header.msg_hdr.msg_flags & MSG_TRUNC) != 0){
+				++m_numPacketsTruncated;
+				continue;
+			}
+
+			PacketSlot& packet = m_receiveSlots[message];
+			packet.m_addressLength = header.msg_hdr.msg_namelen;
+			packet.m_packet.SetSize(header.msg_len);
+			if (message != m_numReceived)
+				std::swap(m_receiveSlots[m_numReceived], packet);
+			++m_numReceived;
+		}
+	}
+
+	return m_numReceived;
+}
+
+///=====================================================
+/// Queues a reference to the packet, not a copy; the buffer is released once the batch is flushed
+/// To build a message in place, Acquire a slice from the pool, serialize into it and SetSize before queueing it
+///=====================================================
+void DatagramSocket::QueueSend(const sockaddr* address, socklen_t addressLength, const PacketSlice& packet){
+	FATAL_ASSERT(IsOpen() && !packet.IsEmpty() && packet.GetSize() <= MAX_DATAGRAM_BYTES && addressLength <= sizeof(sockaddr_storage));
+	if (m_numQueuedSends == m_batchSize)
+		FlushSends();
+
+	PacketSlot& slot = m_sendSlots[m_numQueuedSends++];
+	memcpy(&slot.m_address, address, addressLength);
+	slot.m_addressLength = addressLength;
+	slot.m_packet = packet;
+}
+
+///=====================================================
+/// Sends every queued datagram with as few sendmmsg calls as the socket allows
+/// UDP gives no delivery promise, so whatever the socket won't take right now is dropped rather than held
+///=====================================================
+void DatagramSocket::FlushSends(){
+	FATAL_ASSERT(IsOpen());
+
+	for (int slot = 0; slot < m_numQueuedSends; ++slot){
+		PacketSlot& packet = m_sendSlots[slot];
+		m_ioVectors[slot].iov_base = packet.m_packet.GetData();
+		m_ioVectors[slot].iov_len = packet.m_packet.GetSize();
+
+		msghdr& header = m_messageHeaders[slot].msg_hdr;
+		memset(&header, 0, sizeof(header));
+		header.msg_name = &packet.m_address;
+		header.msg_namelen = packet.m_addressLength;
+		header.msg_iov = &m_ioVectors[slot];
+		header.msg_iovlen = 1;
+	}
+
+	int numSent = 0;
+	while (numSent < m_numQueuedSends){
+		int numMessages = sendmmsg(m_socket, &m_messageHeaders[numSent], m_numQueuedSends - numSent, MSG_DONTWAIT);
+		if (numMessages < 0){
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK){
+				//a bad destination fails only its own datagram; skip it and keep going
+				++m_numPacketsDropped;
+				++numSent;
+				continue;
+			}
+			break;
+		}
+		++m_numSendCalls;
+		m_numPacketsSent += numMessages;
+		numSent += numMessages;
+	}
+
+	m_numPacketsDropped += m_numQueuedSends - numSent;
+	for (int slot = 0; slot < m_numQueuedSends; ++slot){
+		m_sendSlots[slot].m_packet.Reset();
+	}
+	m_numQueuedSends = 0;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void DatagramSocket::PrintStatistics() const{
+	double packetsPerReceive = (m_numReceiveCalls > 0) ? (double)m_numPacketsReceived / (double)m_numReceiveCalls : 0.0;
+	double packetsPerSend = (m_numSendCalls > 0) ? (double)m_numPacketsSent / (double)m_numSendCalls : 0.0;
+
+	ConsolePrintf("Datagrams (batch %d): %llu received in %llu calls (%.1f per call, %llu truncated), %llu sent in %llu calls (%.1f per call, %llu dropped)\n",
+		m_batchSize, m_numPacketsReceived, m_numReceiveCalls, packetsPerReceive, m_numPacketsTruncated, m_numPacketsSent, m_numSendCalls, packetsPerSend, m_numPacketsDropped);
+}
+#endif
\ No newline at end of file
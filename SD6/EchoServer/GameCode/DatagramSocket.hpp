@@ -0,0 +1,82 @@
+//=====================================================
+// DatagramSocket.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_DatagramSocket__
+#define __included_DatagramSocket__
+
+#include <cstddef>
+#include <vector>
+#include "PacketPool.hpp"
+
+#ifdef __linux__
+#include <sys/socket.h>
+
+///=====================================================
+/// Non-blocking UDP socket that moves up to batchSize datagrams per syscall with recvmmsg and sendmmsg (Linux only)
+/// Datagrams are received straight into buffers from the pool and sent straight from whatever slices are queued, so neither direction copies or allocates
+///=====================================================
+class DatagramSocket{
+private:
+	struct PacketSlot{
+		sockaddr_storage m_address;
+		socklen_t m_addressLength;
+		PacketSlice m_packet;
+	};
+
+	int m_socket;
+	int m_batchSize;
+	PacketPool* m_packetPool;
+	std::vector<PacketSlot> m_receiveSlots;
+	std::vector<PacketSlot> m_sendSlots;
+	std::vector<mmsghdr> m_messageHeaders; //shared by both directions, since each call fills them just before the syscall
+	std::vector<iovec> m_ioVectors;
+	int m_numReceived;
+	int m_numQueuedSends;
+
+	unsigned long long m_numReceiveCalls;
+	unsigned long long m_numPacketsReceived;
+	unsigned long long m_numPacketsTruncated;
+	unsigned long long m_numSendCalls;
+	unsigned long long m_numPacketsSent;
+	unsigned long long m_numPacketsDropped;
+
+	DatagramSocket(const DatagramSocket&);
+	DatagramSocket& operator=(const DatagramSocket&);
+
+public:
+	const static int DEFAULT_BATCH_SIZE;
+	const static int MAX_BATCH_SIZE;
+	const static size_t MAX_DATAGRAM_BYTES;
+	const static int PACKET_BUFFERS_PER_BATCH; //pool size per unit of batch size for a socket echoing what it receives
+
+	DatagramSocket();
+	~DatagramSocket();
+
+	bool Open(const char* port, int batchSize, PacketPool& packetPool, bool isPortShared = false);
+	void Close();
+	inline bool IsOpen() const{ return m_socket >= 0; }
+	inline int GetSocket() const{ return m_socket; }
+	inline int GetBatchSize() const{ return m_batchSize; }
+
+	int ReceiveBatch();
+	inline int GetNumReceived() const{ return m_numReceived; }
+	//copy the slice to keep the packet past the next ReceiveBatch; its slot then takes a fresh buffer
+	inline const PacketSlice& GetReceivedPacket(int index) const{ return m_receiveSlots[index].m_packet; }
+	inline const sockaddr* GetReceivedAddress(int index) const{ return (const sockaddr*)&m_receiveSlots[index].m_address; }
+	inline socklen_t GetReceivedAddressLength(int index) const{ return m_receiveSlots[index].m_addressLength; }
+
+	void QueueSend(const sockaddr* address, socklen_t addressLength, const PacketSlice& packet);
+	void FlushSends();
+
+	inline unsigned long long GetNumPacketsReceived() const{ return m_numPacketsReceived; }
+	inline unsigned long long GetNumPacketsSent() const{ return m_numPacketsSent; }
+
+	void PrintStatistics() const;
+};
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,515 @@
+//=====================================================
+// EchoHost.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "Engine/Console/Console.hpp"
+#include "EchoHost.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <cstdlib>
+#include <unistd.h>
+
+const int EchoHost::DEFAULT_MAX_CONNECTIONS = 4096;
+const size_t EchoHost::MAX_QUEUED_BYTES = 256 * 1024;
+
+static const unsigned long long LISTEN_EVENT_TAG = ~0ull;
+static const unsigned long long DATAGRAM_EVENT_TAG = ~1ull;
+static const unsigned long long NETWORK_THREAD_EVENT_TAG = ~2ull;
+static const int MAX_EVENTS_PER_WAIT = 256;
+static const int WAIT_TIMEOUT_MILLISECONDS = 100;
+static const size_t READ_CHUNK_BYTES = 16 * 1024;
+//stdio, the listen socket and the epoll instance, with a few spare for whatever else the process opens
+static const int HOST_DESCRIPTORS = 8;
+
+///=====================================================
+/// Each connection holds a descriptor, so a capacity past the soft limit needs the limit raised; the hard limit still wins
+/// Returns the soft limit now in effect, capped at numDescriptors
+///=====================================================
+static int RaiseDescriptorLimit(int numDescriptors){
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= (rlim_t)numDescriptors)
+		return numDescriptors;
+
+	rlim_t softLimit = limit.rlim_cur;
+	limit.rlim_cur = (limit.rlim_max < (rlim_t)numDescriptors) ? limit.rlim_max : (rlim_t)numDescriptors;
+	if (setrlimit(RLIMIT_NOFILE, &limit) != 0)
+		return (int)softLimit;
+	return (int)limit.rlim_cur;
+}
+
+///=====================================================
+/// Descriptors datagram handling holds on top of the host's own
+///=====================================================
+static int GetNumDatagramDescriptors(DatagramMode datagramMode, int numShards){
+	if (datagramMode == DATAGRAM_MODE_SHARDED)
+		return 1 + DatagramShards::DESCRIPTORS_PER_SHARD * DatagramShards::GetNumShardsToStart(numShards);
+	if (datagramMode == DATAGRAM_MODE_NETWORK_THREAD)
+		return NetworkThread::NUM_DESCRIPTORS;
+	return 1;
+}
+
+///=====================================================
+/// 
+///=====================================================
+EchoHost::EchoHost() :
+m_listenSocket(-1),
+m_epollFD(-1),
+m_maxConnections(0),
+m_connections(),
+m_freeSlots(),
+m_closedSlots(),
+m_packetPool(),
+m_datagramSocket(),
+m_networkThread(),
+m_datagramShards(),
+m_datagramMode(DATAGRAM_MODE_INLINE),
+m_isRunning(false),
+m_numConnections(0),
+m_peakConnections(0),
+m_numAccepted(0),
+m_numRejected(0),
+m_numBytesEchoed(0),
+m_numHandedOver(0),
+m_totalHandOverDelay(0),
+m_maxHandOverDelay(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+EchoHost::~EchoHost(){
+	Shutdown();
+}
+
+///=====================================================
+/// Binds every local interface on port for both TCP and UDP; returns false if either is taken
+///=====================================================
+bool EchoHost::Startup(const char* port, int maxConnections, int datagramBatchSize, DatagramMode datagramMode, int numShards, int shardPortSpan){
+	FATAL_ASSERT(m_listenSocket < 0 && maxConnections > 0);
+
+	//past the descriptor limit accept would fail and leave connections stuck in the backlog, so capacity shrinks to what fits and the rest are rejected
+	int numHostDescriptors = HOST_DESCRIPTORS + GetNumDatagramDescriptors(datagramMode, numShards);
+	int descriptorLimit = RaiseDescriptorLimit(maxConnections + numHostDescriptors);
+	if (descriptorLimit - numHostDescriptors < maxConnections){
+		if (descriptorLimit <= numHostDescriptors){
+			ConsolePrintf("Descriptor limit is %d, leaving no room for connections\n", descriptorLimit);
+			return false;
+		}
+		ConsolePrintf("Descriptor limit is %d, so only %d of the %d connections asked for fit\n", descriptorLimit, descriptorLimit - numHostDescriptors, maxConnections);
+		maxConnections = descriptorLimit - numHostDescriptors;
+	}
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	addrinfo* addresses = nullptr;
+	if (getaddrinfo(nullptr, port, &hints, &addresses) != 0){
+		ConsolePrintf("Failed to resolve port %s\n", port);
+		return false;
+	}
+
+	for (addrinfo* address = addresses; address != nullptr && m_listenSocket < 0; address = address->ai_next){
+		int listenSocket = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+		if (listenSocket < 0) continue;
+
+		int isEnabled = 1;
+		setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &isEnabled, sizeof(isEnabled));
+		if (bind(listenSocket, address->ai_addr, address->ai_addrlen) != 0 || listen(listenSocket, SOMAXCONN) != 0){
+			close(listenSocket);
+			continue;
+		}
+		m_listenSocket = listenSocket;
+	}
+	freeaddrinfo(addresses);
+
+	if (m_listenSocket < 0){
+		ConsolePrintf("Failed to listen on port %s: %s\n", port, strerror(errno));
+		return false;
+	}
+
+	m_epollFD = epoll_create1(EPOLL_CLOEXEC);
+	FATAL_ASSERT(m_epollFD >= 0);
+
+	epoll_event listenEvent;
+	listenEvent.events = EPOLLIN | EPOLLET;
+	listenEvent.data.u64 = LISTEN_EVENT_TAG;
+	epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_listenSocket, &listenEvent);
+
+	//one batch being received plus one being echoed is all the echo ever holds; the rest is headroom
+	//a network thread's rings can each hold a full ring of packets on top of that, and shards bring their own pools
+	int numPacketBuffers = DatagramSocket::PACKET_BUFFERS_PER_BATCH * datagramBatchSize;
+	if (datagramMode == DATAGRAM_MODE_NETWORK_THREAD)
+		numPacketBuffers += 2 * (int)NetworkThread::DEFAULT_RING_CAPACITY;
+	if (datagramMode != DATAGRAM_MODE_SHARDED)
+		m_packetPool.Startup(numPacketBuffers, DatagramSocket::MAX_DATAGRAM_BYTES);
+
+	epoll_event datagramEvent;
+	datagramEvent.events = EPOLLIN | EPOLLET;
+	m_datagramMode = datagramMode;
+	if (datagramMode == DATAGRAM_MODE_SHARDED){
+		if (!m_datagramShards.Start(atoi(port), shardPortSpan, numShards, datagramBatchSize)){
+			Shutdown();
+			return false;
+		}
+	}
+	else if (datagramMode == DATAGRAM_MODE_NETWORK_THREAD){
+		if (!m_networkThread.Start(port, datagramBatchSize, NetworkThread::DEFAULT_RING_CAPACITY, m_packetPool)){
+			Shutdown();
+			return false;
+		}
+		datagramEvent.data.u64 = NETWORK_THREAD_EVENT_TAG;
+		epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_networkThread.GetInboundEventFD(), &datagramEvent);
+	}
+	else{
+		if (!m_datagramSocket.Open(port, datagramBatchSize, m_packetPool)){
+			Shutdown();
+			return false;
+		}
+		datagramEvent.data.u64 = DATAGRAM_EVENT_TAG;
+		epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_datagramSocket.GetSocket(), &datagramEvent);
+	}
+
+	//every slot exists up front, so accepting never grows the table
+	m_maxConnections = maxConnections;
+	m_connections.resize(maxConnections);
+	m_freeSlots.reserve(maxConnections);
+	m_closedSlots.reserve(maxConnections);
+	for (int slot = maxConnections - 1; slot >= 0; --slot){
+		m_connections[slot].m_socket = -1;
+		m_connections[slot].m_writeOffset = 0;
+		m_connections[slot].m_isReadPaused = false;
+		m_connections[slot].m_isClosing = false;
+		m_freeSlots.push_back(slot);
+	}
+
+	static const char* const DATAGRAM_MODE_NAMES[] = { "", " on a network thread", " on shards" };
+	ConsolePrintf("Echo host listening on port %s for up to %d connections, %d datagrams per syscall%s\n", port, maxConnections, datagramBatchSize, DATAGRAM_MODE_NAMES[datagramMode]);
+
+	//set here rather than in Run, so a Stop from a signal handler installed in between isn't overwritten
+	m_isRunning.store(true);
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void EchoHost::Shutdown(){
+	m_isRunning.store(false);
+	for (int slot = 0; slot < (int)m_connections.size(); ++slot){
+		if (m_connections[slot].m_socket >= 0)
+			CloseConnection(slot);
+	}
+	m_connections.clear();
+	m_freeSlots.clear();
+	m_closedSlots.clear();
+	m_datagramShards.Stop();
+	m_networkThread.Stop();
+	m_datagramSocket.Close();
+	if (m_packetPool.GetNumBuffers() > 0)
+		m_packetPool.Shutdown();
+
+	if (m_epollFD >= 0){
+		close(m_epollFD);
+		m_epollFD = -1;
+	}
+	if (m_listenSocket >= 0){
+		close(m_listenSocket);
+		m_listenSocket = -1;
+	}
+}
+
+///=====================================================
+/// Serves every connection until Stop is called, which may already have happened since Startup
+///=====================================================
+void EchoHost::Run(){
+	FATAL_ASSERT(m_epollFD >= 0);
+
+	epoll_event events[MAX_EVENTS_PER_WAIT];
+	while (m_isRunning.load()){
+		int numEvents = epoll_wait(m_epollFD, events, MAX_EVENTS_PER_WAIT, WAIT_TIMEOUT_MILLISECONDS);
+		if (numEvents < 0){
+			if (errno == EINTR) continue;
+			ConsolePrintf("epoll_wait failed: %s\n", strerror(errno));
+			break;
+		}
+
+		for (int eventIndex = 0; eventIndex < numEvents; ++eventIndex){
+			const epoll_event& event = events[eventIndex];
+			if (event.data.u64 == LISTEN_EVENT_TAG){
+				AcceptConnections();
+				continue;
+			}
+			if (event.data.u64 == DATAGRAM_EVENT_TAG){
+				EchoDatagrams();
+				continue;
+			}
+			if (event.data.u64 == NETWORK_THREAD_EVENT_TAG){
+				EchoNetworkThreadMessages();
+				continue;
+			}
+
+			int slot = (int)event.data.u64;
+			if (m_connections[slot].m_socket < 0) continue; //closed earlier in this batch
+
+			if ((event.events & (EPOLLERR | EPOLLHUP)) != 0){
+				CloseConnection(slot);
+				continue;
+			}
+			//writing first frees queue space, which may let a paused read resume in the same pass
+			if ((event.events & EPOLLOUT) != 0)
+				HandleWritable(slot);
+			if ((event.events & (EPOLLIN | EPOLLRDHUP)) != 0 && m_connections[slot].m_socket >= 0)
+				HandleReadable(slot);
+		}
+
+		//only reused once the batch is done, so a stale event can't land on a new connection in the same slot
+		m_freeSlots.insert(m_freeSlots.end(), m_closedSlots.begin(), m_closedSlots.end());
+		m_closedSlots.clear();
+	}
+
+	m_networkThread.Stop();
+	m_datagramShards.Stop();
+}
+
+///=====================================================
+/// Edge-triggered, so the backlog is drained until accept would block
+///=====================================================
+void EchoHost::AcceptConnections(){
+	for (;;){
+		int connectionSocket = accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (connectionSocket < 0){
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				ConsolePrintf("accept failed: %s\n", strerror(errno));
+			return;
+		}
+
+		if (m_freeSlots.empty()){
+			close(connectionSocket);
+			++m_numRejected;
+			continue;
+		}
+
+		int slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+
+		int isEnabled = 1;
+		setsockopt(connectionSocket, IPPROTO_TCP, TCP_NODELAY, &isEnabled, sizeof(isEnabled));
+
+		Connection& connection = m_connections[slot];
+		connection.m_socket = connectionSocket;
+		connection.m_writeQueue.clear();
+		connection.m_writeOffset = 0;
+		connection.m_isReadPaused = false;
+		connection.m_isClosing = false;
+
+		//both directions are registered once; with edge triggering an idle EPOLLOUT costs nothing
+		epoll_event connectionEvent;
+		connectionEvent.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		connectionEvent.data.u64 = (unsigned long long)slot;
+		epoll_ctl(m_epollFD, EPOLL_CTL_ADD, connectionSocket, &connectionEvent);
+
+		++m_numAccepted;
+		++m_numConnections;
+		if (m_numConnections > m_peakConnections)
+			m_peakConnections = m_numConnections;
+	}
+}
+
+///=====================================================
+/// Reads until the socket would block or the write queue is full; a paused read is resumed by HandleWritable
+///=====================================================
+void EchoHost::HandleReadable(int slot){
+	Connection& connection = m_connections[slot];
+	if (connection.m_isClosing)
+		return;
+
+	char buffer[READ_CHUNK_BYTES];
+
+	for (;;){
+		if (connection.m_writeQueue.size() - connection.m_writeOffset >= MAX_QUEUED_BYTES){
+			connection.m_isReadPaused = true;
+			return;
+		}
+
+		ssize_t numBytesRead = recv(connection.m_socket, buffer, sizeof(buffer), 0);
+		if (numBytesRead > 0){
+			if (!QueueEcho(connection, buffer, (size_t)numBytesRead)){
+				CloseConnection(slot);
+				return;
+			}
+			continue;
+		}
+
+		if (numBytesRead < 0 && errno == EINTR) continue;
+		if (numBytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+		//0 is an orderly close, which still gets back everything it sent; anything else is a reset
+		if (numBytesRead == 0 && connection.m_writeOffset < connection.m_writeQueue.size()){
+			connection.m_isClosing = true;
+			return;
+		}
+		CloseConnection(slot);
+		return;
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+void EchoHost::HandleWritable(int slot){
+	Connection& connection = m_connections[slot];
+	if (!FlushWriteQueue(connection) || (connection.m_isClosing && connection.m_writeQueue.empty())){
+		CloseConnection(slot);
+		return;
+	}
+
+	if (connection.m_isReadPaused && connection.m_writeQueue.size() - connection.m_writeOffset < MAX_QUEUED_BYTES){
+		connection.m_isReadPaused = false;
+		HandleReadable(slot);
+	}
+}
+
+///=====================================================
+/// Sends straight away when nothing is queued ahead of the data, and queues only what the socket wouldn't take
+///=====================================================
+bool EchoHost::QueueEcho(Connection& connection, const char* data, size_t numBytes){
+	m_numBytesEchoed += numBytes;
+
+	if (connection.m_writeOffset == connection.m_writeQueue.size()){
+		while (numBytes > 0){
+			ssize_t numBytesSent = send(connection.m_socket, data, numBytes, MSG_NOSIGNAL);
+			if (numBytesSent < 0){
+				if (errno == EINTR) continue;
+				if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+				return false;
+			}
+			data += numBytesSent;
+			numBytes -= (size_t)numBytesSent;
+		}
+	}
+
+	connection.m_writeQueue.insert(connection.m_writeQueue.end(), data, data + numBytes);
+	return true;
+}
+
+///=====================================================
+/// Returns false if the connection failed
+///=====================================================
+bool EchoHost::FlushWriteQueue(Connection& connection){
+	while (connection.m_writeOffset < connection.m_writeQueue.size()){
+		ssize_t numBytesSent = send(connection.m_socket, &connection.m_writeQueue[connection.m_writeOffset], connection.m_writeQueue.size() - connection.m_writeOffset, MSG_NOSIGNAL);
+		if (numBytesSent < 0){
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		connection.m_writeOffset += (size_t)numBytesSent;
+	}
+
+	//keeps the capacity, so a busy connection stops allocating once its queue has grown
+	if (connection.m_writeOffset == connection.m_writeQueue.size()){
+		connection.m_writeQueue.clear();
+		connection.m_writeOffset = 0;
+	}
+	return true;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void EchoHost::CloseConnection(int slot){
+	Connection& connection = m_connections[slot];
+	FATAL_ASSERT(connection.m_socket >= 0);
+
+	//closing removes it from the epoll set too, but events already returned by this wait may still name the slot
+	epoll_ctl(m_epollFD, EPOLL_CTL_DEL, connection.m_socket, nullptr);
+	close(connection.m_socket);
+	connection.m_socket = -1;
+	std::vector<char>().swap(connection.m_writeQueue);
+	connection.m_writeOffset = 0;
+	connection.m_isReadPaused = false;
+	connection.m_isClosing = false;
+
+	m_closedSlots.push_back(slot);
+	--m_numConnections;
+}
+
+///=====================================================
+/// Edge-triggered, so the socket is drained; each received batch goes back out as one send batch
+///=====================================================
+void EchoHost::EchoDatagrams(){
+	for (;;){
+		int numReceived = m_datagramSocket.ReceiveBatch();
+		if (numReceived == 0)
+			return;
+
+		for (int packet = 0; packet < numReceived; ++packet){
+			m_datagramSocket.QueueSend(m_datagramSocket.GetReceivedAddress(packet), m_datagramSocket.GetReceivedAddressLength(packet), m_datagramSocket.GetReceivedPacket(packet));
+		}
+		m_datagramSocket.FlushSends();
+	}
+}
+
+///=====================================================
+/// Every message goes straight back to the network thread in the same buffer, with one wake for the lot
+/// Whatever doesn't fit in the outbound ring stays inbound, where it backs up into the network thread's receive pause
+///=====================================================
+void EchoHost::EchoNetworkThreadMessages(){
+	m_networkThread.ClearInboundEvent();
+
+	NetworkMessage message;
+	bool didPush = false;
+	while (m_networkThread.CanPushOutbound() && m_networkThread.PopInbound(message)){
+		std::chrono::steady_clock::duration handOverDelay = std::chrono::steady_clock::now() - message.m_receiveTime;
+		m_totalHandOverDelay += handOverDelay;
+		if (handOverDelay > m_maxHandOverDelay)
+			m_maxHandOverDelay = handOverDelay;
+		++m_numHandedOver;
+
+		m_networkThread.PushOutbound(std::move(message));
+		didPush = true;
+	}
+
+	if (didPush)
+		m_networkThread.FlushOutbound();
+}
+
+///=====================================================
+/// Call once Run has returned
+///=====================================================
+void EchoHost::PrintStatistics() const{
+	ConsolePrintf("Connections: %d open (peak %d of %d), %llu accepted, %llu rejected at capacity, %llu bytes echoed\n",
+		m_numConnections, m_peakConnections, m_maxConnections, m_numAccepted, m_numRejected, m_numBytesEchoed);
+	if (m_datagramMode == DATAGRAM_MODE_SHARDED){
+		m_datagramShards.PrintStatistics();
+		return;
+	}
+
+	if (m_datagramMode == DATAGRAM_MODE_NETWORK_THREAD){
+		typedef std::chrono::duration<double, std::micro> Microseconds;
+		double averageMicroseconds = (m_numHandedOver > 0) ? Microseconds(m_totalHandOverDelay).count() / (double)m_numHandedOver : 0.0;
+		ConsolePrintf("Network thread hand-over: %llu messages, %.1f us average and %.1f us worst from receive to echo\n",
+			m_numHandedOver, averageMicroseconds, Microseconds(m_maxHandOverDelay).count());
+		m_networkThread.PrintStatistics();
+	}
+	else{
+		m_datagramSocket.PrintStatistics();
+	}
+	m_packetPool.PrintStatistics();
+}
+#endif
\ No newline at end of file
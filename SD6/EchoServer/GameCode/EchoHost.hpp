@@ -0,0 +1,101 @@
+//=====================================================
+// EchoHost.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_EchoHost__
+#define __included_EchoHost__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "DatagramShards.hpp"
+#include "DatagramSocket.hpp"
+#include "NetworkThread.hpp"
+#include "PacketPool.hpp"
+
+#ifdef __linux__
+///=====================================================
+/// Where EchoHost handles its datagrams
+///=====================================================
+enum DatagramMode{
+	DATAGRAM_MODE_INLINE, //in the host's own epoll loop
+	DATAGRAM_MODE_NETWORK_THREAD, //I/O on a NetworkThread, echoed by the host's loop
+	DATAGRAM_MODE_SHARDED //by DatagramShards workers, one per core, that never touch the host's loop
+};
+
+///=====================================================
+/// TCP and UDP echo server driven by one epoll readiness loop on the calling thread (Linux only)
+/// Every socket is non-blocking and edge-triggered; whatever can't be written straight back waits in its connection's write queue
+/// Datagrams are received and echoed in batches of datagramBatchSize per syscall, each reply sent from the very buffer it arrived in
+/// datagramMode can move datagram I/O to a NetworkThread, leaving this loop only the echo, or hand datagrams to DatagramShards altogether
+/// maxConnections is a hard capacity, lowered to fit the descriptor limit: connections past it are accepted and closed at once, so they never pile up in the listen backlog
+///=====================================================
+class EchoHost{
+private:
+	struct Connection{
+		int m_socket;
+		std::vector<char> m_writeQueue;
+		size_t m_writeOffset; //bytes at the front of m_writeQueue already sent
+		bool m_isReadPaused; //the write queue hit MAX_QUEUED_BYTES, so input is left in the kernel until it drains
+		bool m_isClosing; //the peer is done sending; closed once everything queued for it has been written
+	};
+
+	int m_listenSocket;
+	int m_epollFD;
+	int m_maxConnections;
+	std::vector<Connection> m_connections; //indexed by slot; a closed slot has m_socket -1
+	std::vector<int> m_freeSlots;
+	std::vector<int> m_closedSlots; //closed during the current wait's batch of events
+	PacketPool m_packetPool; //before the sockets, so they release their buffers before the pool goes away
+	DatagramSocket m_datagramSocket;
+	NetworkThread m_networkThread;
+	DatagramShards m_datagramShards;
+	DatagramMode m_datagramMode;
+	std::atomic<bool> m_isRunning;
+
+	int m_numConnections;
+	int m_peakConnections;
+	unsigned long long m_numAccepted;
+	unsigned long long m_numRejected;
+	unsigned long long m_numBytesEchoed;
+	unsigned long long m_numHandedOver;
+	std::chrono::steady_clock::duration m_totalHandOverDelay; //from the network thread's receive stamp to this loop picking the message up
+	std::chrono::steady_clock::duration m_maxHandOverDelay;
+
+	EchoHost(const EchoHost&);
+	EchoHost& operator=(const EchoHost&);
+
+	void AcceptConnections();
+	void HandleReadable(int slot);
+	void HandleWritable(int slot);
+	bool QueueEcho(Connection& connection, const char* data, size_t numBytes);
+	bool FlushWriteQueue(Connection& connection);
+	void CloseConnection(int slot);
+	void EchoDatagrams();
+	void EchoNetworkThreadMessages();
+
+public:
+	const static int DEFAULT_MAX_CONNECTIONS;
+	const static size_t MAX_QUEUED_BYTES;
+
+	EchoHost();
+	~EchoHost();
+
+	//numShards and shardPortSpan only apply to DATAGRAM_MODE_SHARDED; see DatagramShards::Start
+	bool Startup(const char* port, int maxConnections, int datagramBatchSize = DatagramSocket::DEFAULT_BATCH_SIZE, DatagramMode datagramMode = DATAGRAM_MODE_INLINE, int numShards = 0, int shardPortSpan = 1);
+	void Shutdown();
+
+	//stops the network thread or shards, if any, on the way out
+	void Run();
+	//safe to call from another thread or a signal handler; Run returns within one wait timeout
+	inline void Stop(){ m_isRunning.store(false); }
+
+	void PrintStatistics() const;
+	inline int GetNumConnections() const{ return m_numConnections; }
+};
+#endif
+
+#endif
\ No newline at end of file
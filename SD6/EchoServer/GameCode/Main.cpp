@@ -7,6 +7,31 @@
 #include "Engine/Console/Console.hpp"
 #include "Engine/Core/Utilities.hpp"
 
+#ifdef __linux__
+#include "EchoHost.hpp"
+#include <csignal>
+
+static EchoHost* s_echoHost = nullptr;
+
+///=====================================================
+/// 
+///=====================================================
+static void StopEchoHost(int /*signalNumber*/) {
+	if (s_echoHost != nullptr) {
+		s_echoHost->Stop();
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+static void PrintServerUsage() {
+	ConsolePrintf("Usage: EchoServer server [maxConnections] [datagramBatchSize] [thread]\n");
+	ConsolePrintf("       EchoServer server [maxConnections] [datagramBatchSize] shards [numShards] [portSpan]\n");
+	ConsolePrintf("maxConnections, datagramBatchSize and portSpan must be at least 1; numShards 0 means one per core, and at most %d per core are started\n", DatagramShards::MAX_SHARDS_PER_CORE);
+}
+#endif
+
 int main(int argc, const char** args) {
 	NetworkSystem netSystem;
 
@@ -25,12 +50,71 @@ int main(int argc, const char** args) {
 	}
 
 	if (strcmp(args[1], "server") == 0) { //host
+#ifdef __linux__
+		//one epoll loop serves every connection and datagram; numConnections is its capacity
+		int numConnections = EchoHost::DEFAULT_MAX_CONNECTIONS;
+		if (argc > 2) {
+			GetInt(args[2], numConnections);
+		}
+
+		int datagramBatchSize = DatagramSocket::DEFAULT_BATCH_SIZE;
+		if (argc > 3) {
+			GetInt(args[3], datagramBatchSize);
+		}
+
+		DatagramMode datagramMode = DATAGRAM_MODE_INLINE;
+		int numShards = 0;
+		int shardPortSpan = 1;
+		if (argc > 4 && strcmp(args[4], "thread") == 0) {
+			datagramMode = DATAGRAM_MODE_NETWORK_THREAD;
+		}
+		else if (argc > 4 && strcmp(args[4], "shards") == 0) {
+			datagramMode = DATAGRAM_MODE_SHARDED;
+			if (argc > 5) {
+				GetInt(args[5], numShards);
+			}
+			if (argc > 6) {
+				GetInt(args[6], shardPortSpan);
+			}
+		}
+
+		if (numConnections <= 0 || datagramBatchSize <= 0 || numShards < 0 || shardPortSpan <= 0) {
+			ConsolePrintf("Error: Invalid server arguments.\n");
+			PrintServerUsage();
+			netSystem.Deinit();
+			return 1;
+		}
+
+		//the network thread's rings must hold a full batch
+		int maxBatchSize = DatagramSocket::MAX_BATCH_SIZE;
+		if (datagramMode == DATAGRAM_MODE_NETWORK_THREAD && (int)NetworkThread::DEFAULT_RING_CAPACITY < maxBatchSize) {
+			maxBatchSize = (int)NetworkThread::DEFAULT_RING_CAPACITY;
+		}
+		if (datagramBatchSize > maxBatchSize) {
+			ConsolePrintf("Datagram batch size %d is above the limit, using %d\n", datagramBatchSize, maxBatchSize);
+			datagramBatchSize = maxBatchSize;
+		}
+
+		EchoHost echoHost;
+		if (echoHost.Startup("1234", numConnections, datagramBatchSize, datagramMode, numShards, shardPortSpan)) {
+			s_echoHost = &echoHost;
+			signal(SIGINT, StopEchoHost);
+			signal(SIGTERM, StopEchoHost);
+
+			echoHost.Run();
+			echoHost.PrintStatistics();
+
+			s_echoHost = nullptr;
+			echoHost.Shutdown();
+		}
+#else
 		int numConnections = 8;
 		if (argc > 2) {
 			GetInt(args[2], numConnections);
 		}
 
 		netSystem.StartHost(hostName, "1234", numConnections);
+#endif
 	}
 	else { //client
 		const char* hostNameArg = args[1];
@@ -0,0 +1,252 @@
+//=====================================================
+// NetworkThread.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "Engine/Console/Console.hpp"
+#include "NetworkThread.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+const size_t NetworkThread::DEFAULT_RING_CAPACITY = 1024;
+const int NetworkThread::NUM_DESCRIPTORS = 4;
+
+static const int WAIT_TIMEOUT_MILLISECONDS = 100;
+
+///=====================================================
+/// 
+///=====================================================
+static void SignalEventFD(int eventFD){
+	unsigned long long count = 1;
+	ssize_t numBytesWritten = write(eventFD, &count, sizeof(count));
+	(void)numBytesWritten; //only fails when the counter is already huge, which still wakes the reader
+}
+
+///=====================================================
+/// 
+///=====================================================
+static void ClearEventFD(int eventFD){
+	unsigned long long count;
+	ssize_t numBytesRead = read(eventFD, &count, sizeof(count));
+	(void)numBytesRead; //EAGAIN just means nothing was signalled
+}
+
+///=====================================================
+/// 
+///=====================================================
+NetworkThread::NetworkThread() :
+m_socket(),
+m_inbound(),
+m_outbound(),
+m_epollFD(-1),
+m_wakeEventFD(-1),
+m_inboundEventFD(-1),
+m_thread(),
+m_isRunning(false),
+m_isReceivePaused(false),
+m_numReceivePauses(0),
+m_numOutboundStalls(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+NetworkThread::~NetworkThread(){
+	Stop();
+}
+
+///=====================================================
+/// Opens the socket and starts the thread; packetPool must outlive it
+///=====================================================
+bool NetworkThread::Start(const char* port, int batchSize, size_t ringCapacity, PacketPool& packetPool){
+	FATAL_ASSERT(!IsRunning() && ringCapacity >= (size_t)batchSize);
+	if (!m_socket.Open(port, batchSize, packetPool))
+		return false;
+
+	m_inbound.Startup(ringCapacity);
+	m_outbound.Startup(ringCapacity);
+
+	m_epollFD = epoll_create1(EPOLL_CLOEXEC);
+	m_wakeEventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	m_inboundEventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	FATAL_ASSERT(m_epollFD >= 0 && m_wakeEventFD >= 0 && m_inboundEventFD >= 0);
+
+	epoll_event socketEvent;
+	socketEvent.events = EPOLLIN | EPOLLET;
+	socketEvent.data.fd = m_socket.GetSocket();
+	epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_socket.GetSocket(), &socketEvent);
+
+	epoll_event wakeEvent;
+	wakeEvent.events = EPOLLIN;
+	wakeEvent.data.fd = m_wakeEventFD;
+	epoll_ctl(m_epollFD, EPOLL_CTL_ADD, m_wakeEventFD, &wakeEvent);
+
+	m_isReceivePaused = false;
+	m_isRunning.store(true);
+	m_thread = std::thread(&NetworkThread::Run, this);
+	return true;
+}
+
+///=====================================================
+/// Joins the thread and closes everything; messages still in either ring are dropped
+///=====================================================
+void NetworkThread::Stop(){
+	if (m_thread.joinable()){
+		m_isRunning.store(false);
+		SignalEventFD(m_wakeEventFD);
+		m_thread.join();
+	}
+
+	//the thread is gone, so this side can empty both rings and give their buffers back
+	NetworkMessage message;
+	while (m_inbound.TryPop(message)){}
+	while (m_outbound.TryPop(message)){}
+	message.m_packet.Reset();
+	m_socket.Close();
+
+	int* fileDescriptors[3] = { &m_epollFD, &m_wakeEventFD, &m_inboundEventFD };
+	for (int descriptor = 0; descriptor < 3; ++descriptor){
+		if (*fileDescriptors[descriptor] >= 0){
+			close(*fileDescriptors[descriptor]);
+			*fileDescriptors[descriptor] = -1;
+		}
+	}
+}
+
+///=====================================================
+/// Network thread: sleeps until the socket is readable or the game thread has something to send
+///=====================================================
+void NetworkThread::Run(){
+	epoll_event events[2];
+	while (m_isRunning.load()){
+		int numEvents = epoll_wait(m_epollFD, events, 2, WAIT_TIMEOUT_MILLISECONDS);
+		if (numEvents < 0 && errno != EINTR){
+			ConsolePrintf("Network thread epoll_wait failed: %s\n", strerror(errno));
+			break;
+		}
+
+		bool isSocketReadable = m_isReceivePaused;
+		for (int eventIndex = 0; eventIndex < numEvents; ++eventIndex){
+			if (events[eventIndex].data.fd == m_wakeEventFD)
+				ClearEventFD(m_wakeEventFD);
+			else
+				isSocketReadable = true;
+		}
+
+		//the socket is edge-triggered, so a paused receive is retried every pass rather than waiting for another edge
+		if (isSocketReadable)
+			ReceiveMessages();
+		//checked every pass, so a wake that raced the clear above still gets its messages sent
+		SendMessages();
+	}
+}
+
+///=====================================================
+/// Network thread: drains the socket, stamping each datagram as its batch arrives
+///=====================================================
+void NetworkThread::ReceiveMessages(){
+	bool didQueue = false;
+	bool wasReceivePaused = m_isReceivePaused;
+	m_isReceivePaused = false;
+	for (;;){
+		if (m_inbound.GetCapacity() - m_inbound.GetSize() < (size_t)m_socket.GetBatchSize()){
+			m_isReceivePaused = true;
+			//counts pauses, not the passes spent retrying one
+			if (!wasReceivePaused)
+				++m_numReceivePauses;
+			break;
+		}
+
+		int numReceived = m_socket.ReceiveBatch();
+		if (numReceived == 0)
+			break;
+		wasReceivePaused = false; //resumed, so running out of room again is a new pause
+
+		std::chrono::steady_clock::time_point receiveTime = std::chrono::steady_clock::now();
+		for (int packet = 0; packet < numReceived; ++packet){
+			NetworkMessage message;
+			memcpy(&message.m_address, m_socket.GetReceivedAddress(packet), m_socket.GetReceivedAddressLength(packet));
+			message.m_addressLength = m_socket.GetReceivedAddressLength(packet);
+			message.m_packet = m_socket.GetReceivedPacket(packet);
+			message.m_receiveTime = receiveTime;
+
+			bool didPush = m_inbound.TryPush(std::move(message));
+			FATAL_ASSERT(didPush); //room was checked before receiving
+			didQueue = true;
+		}
+	}
+
+	if (didQueue)
+		SignalEventFD(m_inboundEventFD);
+}
+
+///=====================================================
+/// Network thread
+///=====================================================
+void NetworkThread::SendMessages(){
+	NetworkMessage message;
+	bool didQueue = false;
+	while (m_outbound.TryPop(message)){
+		m_socket.QueueSend((const sockaddr*)&message.m_address, message.m_addressLength, message.m_packet);
+		didQueue = true;
+	}
+	message.m_packet.Reset();
+
+	if (didQueue){
+		m_socket.FlushSends();
+
+		//the game thread may have left inbound messages queued while the outbound ring was full; there is room for them now
+		if (!m_inbound.IsEmpty())
+			SignalEventFD(m_inboundEventFD);
+	}
+}
+
+///=====================================================
+/// Call before popping, so a signal for messages pushed after the last pop is never lost
+///=====================================================
+void NetworkThread::ClearInboundEvent(){
+	ClearEventFD(m_inboundEventFD);
+}
+
+///=====================================================
+/// Read on the producer side, so a full answer can be stale but a room answer never is
+///=====================================================
+bool NetworkThread::CanPushOutbound(){
+	if (m_outbound.GetSize() < m_outbound.GetCapacity())
+		return true;
+
+	++m_numOutboundStalls;
+	return false;
+}
+
+///=====================================================
+/// Nothing is sent until FlushOutbound; only call once CanPushOutbound has returned true
+///=====================================================
+void NetworkThread::PushOutbound(NetworkMessage&& message){
+	bool didPush = m_outbound.TryPush(std::move(message));
+	FATAL_ASSERT(didPush);
+}
+
+///=====================================================
+/// Wakes the network thread to send everything pushed so far
+///=====================================================
+void NetworkThread::FlushOutbound(){
+	SignalEventFD(m_wakeEventFD);
+}
+
+///=====================================================
+/// Only once stopped, since the socket's counters belong to the network thread while it runs
+///=====================================================
+void NetworkThread::PrintStatistics() const{
+	FATAL_ASSERT(!IsRunning());
+	ConsolePrintf("Network thread rings (capacity %d): receiving paused %llu times for a full inbound ring, outbound ring full %llu times\n",
+		(int)m_inbound.GetCapacity(), m_numReceivePauses, m_numOutboundStalls);
+	m_socket.PrintStatistics();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+//=====================================================
+// NetworkThread.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_NetworkThread__
+#define __included_NetworkThread__
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "DatagramSocket.hpp"
+#include "PacketPool.hpp"
+#include "SpscRing.hpp"
+
+#ifdef __linux__
+///=====================================================
+/// A datagram and its peer, stamped on the network thread as it came off the socket
+///=====================================================
+struct NetworkMessage{
+	sockaddr_storage m_address;
+	socklen_t m_addressLength;
+	PacketSlice m_packet;
+	std::chrono::steady_clock::time_point m_receiveTime;
+};
+
+///=====================================================
+/// Runs a DatagramSocket's I/O on its own thread, so a slow game frame delays neither receiving nor sending (Linux only)
+/// Messages cross to and from the game thread through two SPSC rings; GetInboundEventFD becomes readable whenever inbound messages arrive
+/// While the inbound ring has no room for a full batch, datagrams are left queued in the socket until the game thread catches up
+/// The game thread in turn stops popping inbound messages while the outbound ring is full, so a backed-up send side pauses receiving too
+///=====================================================
+class NetworkThread{
+private:
+	DatagramSocket m_socket;
+	SpscRing<NetworkMessage> m_inbound;
+	SpscRing<NetworkMessage> m_outbound;
+	int m_epollFD;
+	int m_wakeEventFD; //written by the game thread when it has queued outbound messages, or to stop
+	int m_inboundEventFD; //written by the network thread when it has queued inbound messages
+	std::thread m_thread;
+	std::atomic<bool> m_isRunning;
+	bool m_isReceivePaused; //network thread only
+
+	unsigned long long m_numReceivePauses; //network thread only
+	unsigned long long m_numOutboundStalls; //game thread only
+
+	NetworkThread(const NetworkThread&);
+	NetworkThread& operator=(const NetworkThread&);
+
+	void Run();
+	void ReceiveMessages();
+	void SendMessages();
+
+public:
+	const static size_t DEFAULT_RING_CAPACITY;
+	const static int NUM_DESCRIPTORS; //held while running: the socket, the thread's epoll instance and both eventfds
+
+	NetworkThread();
+	~NetworkThread();
+
+	bool Start(const char* port, int batchSize, size_t ringCapacity, PacketPool& packetPool);
+	void Stop();
+	inline bool IsRunning() const{ return m_thread.joinable(); }
+
+	//game thread only
+	inline int GetInboundEventFD() const{ return m_inboundEventFD; }
+	void ClearInboundEvent();
+	inline bool PopInbound(NetworkMessage& out_message){ return m_inbound.TryPop(out_message); }
+	//check before popping a message to reply to; once it's false, leave the rest queued until the inbound event fires again
+	bool CanPushOutbound();
+	void PushOutbound(NetworkMessage&& message);
+	//also call after popping inbound messages, so a paused receive can resume
+	void FlushOutbound();
+
+	void PrintStatistics() const;
+};
+#endif
+
+#endif
\ No newline at end of file
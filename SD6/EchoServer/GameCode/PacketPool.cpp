@@ -0,0 +1,225 @@
+//=====================================================
+// PacketPool.cpp
+// by Andrew Socha
+//=====================================================
+
+#include "Engine/Core/EngineCore.hpp"
+#include "Engine/Console/Console.hpp"
+#include "PacketPool.hpp"
+
+///=====================================================
+/// 
+///=====================================================
+PacketPool::PacketPool() :
+m_storage(),
+m_refCounts(),
+m_numBuffers(0),
+m_bufferBytes(0),
+m_freeBuffersMutex(),
+m_freeBuffers(),
+m_numInUse(0),
+m_peakInUse(0),
+m_numAcquired(0),
+m_numExhausted(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+void PacketPool::Startup(int numBuffers, size_t bufferBytes){
+	FATAL_ASSERT(m_storage.empty() && numBuffers > 0 && bufferBytes > 0);
+
+	m_numBuffers = numBuffers;
+	m_bufferBytes = bufferBytes;
+	m_storage.resize(numBuffers * bufferBytes);
+	m_refCounts.reset(new std::atomic<int>[numBuffers]);
+	m_freeBuffers.reserve(numBuffers);
+	for (int bufferIndex = numBuffers - 1; bufferIndex >= 0; --bufferIndex){
+		m_refCounts[bufferIndex].store(0, std::memory_order_relaxed);
+		m_freeBuffers.push_back(bufferIndex);
+	}
+}
+
+///=====================================================
+/// Every slice must have been released first, and no other thread may still be using the pool
+///=====================================================
+void PacketPool::Shutdown(){
+	FATAL_ASSERT(GetNumInUse() == 0);
+	std::vector<char>().swap(m_storage);
+	m_refCounts.reset();
+	m_numBuffers = 0;
+	m_freeBuffers.clear();
+}
+
+///=====================================================
+/// The slice spans the whole buffer with size 0; returns an empty slice if the pool is exhausted
+///=====================================================
+PacketSlice PacketPool::Acquire(){
+	int bufferIndex;
+	{
+		std::lock_guard<std::mutex> freeBuffersLock(m_freeBuffersMutex);
+		if (m_freeBuffers.empty()){
+			m_numExhausted.fetch_add(1, std::memory_order_relaxed);
+			return PacketSlice();
+		}
+
+		bufferIndex = m_freeBuffers.back();
+		m_freeBuffers.pop_back();
+
+		int numInUse = m_numInUse.fetch_add(1, std::memory_order_relaxed) + 1;
+		if (numInUse > m_peakInUse.load(std::memory_order_relaxed))
+			m_peakInUse.store(numInUse, std::memory_order_relaxed);
+	}
+	m_numAcquired.fetch_add(1, std::memory_order_relaxed);
+
+	//the slice's constructor adds the one reference
+	return PacketSlice(this, bufferIndex, 0);
+}
+
+///=====================================================
+/// 
+///=====================================================
+void PacketPool::AddReference(int bufferIndex){
+	m_refCounts[bufferIndex].fetch_add(1, std::memory_order_relaxed);
+}
+
+///=====================================================
+/// acq_rel, so every write through any slice is done before the buffer can be handed out again
+///=====================================================
+void PacketPool::Release(int bufferIndex){
+	int previousRefCount = m_refCounts[bufferIndex].fetch_sub(1, std::memory_order_acq_rel);
+	FATAL_ASSERT(previousRefCount > 0);
+	if (previousRefCount == 1){
+		std::lock_guard<std::mutex> freeBuffersLock(m_freeBuffersMutex);
+		m_freeBuffers.push_back(bufferIndex);
+		m_numInUse.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+///=====================================================
+/// 
+///=====================================================
+void PacketPool::PrintStatistics() const{
+	ConsolePrintf("Packet pool: %d of %d buffers in use (peak %d), %llu acquired, %llu exhausted\n",
+		GetNumInUse(), GetNumBuffers(), GetPeakInUse(), m_numAcquired.load(std::memory_order_relaxed), GetNumExhausted());
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice::PacketSlice() :
+m_pool(nullptr),
+m_bufferIndex(-1),
+m_offset(0),
+m_numBytes(0){
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice::PacketSlice(PacketPool* pool, int bufferIndex, size_t numBytes) :
+m_pool(pool),
+m_bufferIndex(bufferIndex),
+m_offset(0),
+m_numBytes(numBytes){
+	m_pool->AddReference(m_bufferIndex);
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice::PacketSlice(const PacketSlice& other) :
+m_pool(other.m_pool),
+m_bufferIndex(other.m_bufferIndex),
+m_offset(other.m_offset),
+m_numBytes(other.m_numBytes){
+	if (m_pool != nullptr)
+		m_pool->AddReference(m_bufferIndex);
+}
+
+///=====================================================
+/// Takes over other's reference, leaving it empty
+///=====================================================
+PacketSlice::PacketSlice(PacketSlice&& other) :
+m_pool(other.m_pool),
+m_bufferIndex(other.m_bufferIndex),
+m_offset(other.m_offset),
+m_numBytes(other.m_numBytes){
+	other.m_pool = nullptr;
+	other.m_bufferIndex = -1;
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice::~PacketSlice(){
+	Reset();
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice& PacketSlice::operator=(const PacketSlice& other){
+	if (this != &other){
+		//referenced before releasing, in case both view the same buffer
+		if (other.m_pool != nullptr)
+			other.m_pool->AddReference(other.m_bufferIndex);
+		Reset();
+
+		m_pool = other.m_pool;
+		m_bufferIndex = other.m_bufferIndex;
+		m_offset = other.m_offset;
+		m_numBytes = other.m_numBytes;
+	}
+	return *this;
+}
+
+///=====================================================
+/// 
+///=====================================================
+PacketSlice& PacketSlice::operator=(PacketSlice&& other){
+	if (this != &other){
+		Reset();
+
+		m_pool = other.m_pool;
+		m_bufferIndex = other.m_bufferIndex;
+		m_offset = other.m_offset;
+		m_numBytes = other.m_numBytes;
+		other.m_pool = nullptr;
+		other.m_bufferIndex = -1;
+	}
+	return *this;
+}
+
+///=====================================================
+/// Releases the buffer and leaves the slice empty
+///=====================================================
+void PacketSlice::Reset(){
+	if (m_pool != nullptr){
+		m_pool->Release(m_bufferIndex);
+		m_pool = nullptr;
+		m_bufferIndex = -1;
+	}
+	m_offset = 0;
+	m_numBytes = 0;
+}
+
+///=====================================================
+/// 
+///=====================================================
+void PacketSlice::SetSize(size_t numBytes){
+	FATAL_ASSERT(!IsEmpty() && numBytes <= GetCapacity());
+	m_numBytes = numBytes;
+}
+
+///=====================================================
+/// Views part of this slice, sharing its buffer; e.g. a message's payload without its header
+///=====================================================
+PacketSlice PacketSlice::GetSubSlice(size_t offset, size_t numBytes) const{
+	FATAL_ASSERT(!IsEmpty() && offset + numBytes <= m_numBytes);
+
+	PacketSlice subSlice(*this);
+	subSlice.m_offset += offset;
+	subSlice.m_numBytes = numBytes;
+	return subSlice;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+//=====================================================
+// PacketPool.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_PacketPool__
+#define __included_PacketPool__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class PacketSlice;
+
+///=====================================================
+/// Fixed number of same-size packet buffers carved out of one allocation, each reference counted by the PacketSlices that view it
+/// A buffer goes back on the free list when its last slice is released; when none are free, Acquire fails and counts an exhaustion instead of allocating
+/// Slices may be handed between threads: reference counts are atomic, and only Acquire and a last Release take the free list's lock
+///=====================================================
+class PacketPool{
+private:
+	std::vector<char> m_storage;
+	std::unique_ptr<std::atomic<int>[]> m_refCounts;
+	int m_numBuffers;
+	size_t m_bufferBytes;
+
+	std::mutex m_freeBuffersMutex;
+	std::vector<int> m_freeBuffers;
+	std::atomic<int> m_numInUse;
+	std::atomic<int> m_peakInUse;
+	std::atomic<unsigned long long> m_numAcquired;
+	std::atomic<unsigned long long> m_numExhausted;
+
+	PacketPool(const PacketPool&);
+	PacketPool& operator=(const PacketPool&);
+
+	friend class PacketSlice;
+	void AddReference(int bufferIndex);
+	void Release(int bufferIndex);
+
+public:
+	PacketPool();
+
+	void Startup(int numBuffers, size_t bufferBytes);
+	void Shutdown();
+
+	PacketSlice Acquire();
+
+	inline size_t GetBufferBytes() const{ return m_bufferBytes; }
+	inline int GetNumBuffers() const{ return m_numBuffers; }
+	inline int GetNumInUse() const{ return m_numInUse.load(std::memory_order_relaxed); }
+	inline int GetPeakInUse() const{ return m_peakInUse.load(std::memory_order_relaxed); }
+	inline unsigned long long GetNumExhausted() const{ return m_numExhausted.load(std::memory_order_relaxed); }
+
+	void PrintStatistics() const;
+};
+
+///=====================================================
+/// A reference to a byte range of one pool buffer; copies share the buffer, so passing a packet on never copies its bytes
+/// An empty slice (failed Acquire, or default constructed) views nothing
+///=====================================================
+class PacketSlice{
+private:
+	PacketPool* m_pool;
+	int m_bufferIndex;
+	size_t m_offset;
+	size_t m_numBytes;
+
+	friend class PacketPool;
+	PacketSlice(PacketPool* pool, int bufferIndex, size_t numBytes);
+
+public:
+	PacketSlice();
+	PacketSlice(const PacketSlice& other);
+	PacketSlice(PacketSlice&& other);
+	~PacketSlice();
+
+	PacketSlice& operator=(const PacketSlice& other);
+	PacketSlice& operator=(PacketSlice&& other);
+
+	void Reset();
+
+	inline bool IsEmpty() const{ return m_pool == nullptr; }
+	inline char* GetData() const{ return &m_pool->m_storage[m_bufferIndex * m_pool->m_bufferBytes + m_offset]; }
+	inline size_t GetSize() const{ return m_numBytes; }
+	inline size_t GetCapacity() const{ return m_pool->m_bufferBytes - m_offset; }
+	//only meaningful to a holder of the slice: no one else can add a reference, though they may drop theirs at any time
+	inline bool IsUnique() const{ return m_pool->m_refCounts[m_bufferIndex].load(std::memory_order_acquire) == 1; }
+
+	//how much of the buffer is filled in, e.g. after receiving or serializing into it; at most GetCapacity
+	void SetSize(size_t numBytes);
+	PacketSlice GetSubSlice(size_t offset, size_t numBytes) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+//=====================================================
+// SpscRing.hpp
+// by Andrew Socha
+//=====================================================
+
+#pragma once
+
+#ifndef __included_SpscRing__
+#define __included_SpscRing__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+///=====================================================
+/// Bounded lock-free queue between exactly one producer thread and one consumer thread
+/// Values are moved in and out of slots allocated once by Startup, so pushing and popping never allocate; a full ring refuses the push
+///=====================================================
+template <typename T>
+class SpscRing{
+private:
+	std::vector<T> m_slots;
+	size_t m_indexMask;
+
+	//each index is written by one side only; keeping them on separate cache lines stops the two threads fighting over one
+	alignas(64) std::atomic<size_t> m_head; //next slot to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_tail; //next slot to push, written by the producer
+
+	SpscRing(const SpscRing&);
+	SpscRing& operator=(const SpscRing&);
+
+public:
+	SpscRing();
+
+	void Startup(size_t capacity);
+
+	inline bool TryPush(T&& value);
+	inline bool TryPop(T& out_value);
+
+	inline size_t GetCapacity() const{ return m_slots.size(); }
+	//exact on neither side while the other is active, but never less than is really queued when read by the producer, nor more when read by the consumer
+	inline size_t GetSize() const{ return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+	inline bool IsEmpty() const{ return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+};
+
+
+///=====================================================
+/// 
+///=====================================================
+template <typename T>
+SpscRing<T>::SpscRing() :
+m_slots(),
+m_indexMask(0),
+m_head(0),
+m_tail(0){
+}
+
+///=====================================================
+/// capacity is rounded up to a power of two; call before either thread uses the ring
+///=====================================================
+template <typename T>
+void SpscRing<T>::Startup(size_t capacity){
+	size_t roundedCapacity = 1;
+	while (roundedCapacity < capacity){
+		roundedCapacity *= 2;
+	}
+
+	m_slots.clear();
+	m_slots.resize(roundedCapacity);
+	m_indexMask = roundedCapacity - 1;
+	m_head.store(0, std::memory_order_relaxed);
+	m_tail.store(0, std::memory_order_relaxed);
+}
+
+///=====================================================
+/// Producer only; value is left untouched if the ring is full
+///=====================================================
+template <typename T>
+bool SpscRing<T>::TryPush(T&& value){
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+		return false;
+
+	m_slots[tail & m_indexMask] = std::move(value);
+	m_tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+///=====================================================
+/// Consumer only
+///=====================================================
+template <typename T>
+bool SpscRing<T>::TryPop(T& out_value){
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_tail.load(std::memory_order_acquire))
+		return false;
+
+	out_value = std::move(m_slots[head & m_indexMask]);
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+#endif
\ No newline at end of file